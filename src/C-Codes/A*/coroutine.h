@@ -0,0 +1,41 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+// coroutine.h - Stackless coroutines for step-driven solvers
+//
+// main.c calls the strategy's step hook once per driver step. A solver
+// written with these macros reads as one straight-line walk: CO_YIELD hands a
+// motion command to the driver and the next call resumes right after it.
+// The resume point is a line number in a switch (protothread style), so
+// locals do not survive a yield; keep walk state in statics, and never yield
+// from inside another switch statement.
+
+typedef struct {
+    int line;  // 0 = not started, -1 = finished
+} Coroutine;
+
+#define CO_BEGIN(co) switch ((co)->line) { case 0:
+
+#define CO_YIELD(co, value)         \
+    do {                            \
+        (co)->line = __LINE__;      \
+        return (value);             \
+        case __LINE__:;             \
+    } while (0)
+
+// Finish early; later calls return 'value' at once
+#define CO_RETURN(co, value) \
+    do {                     \
+        (co)->line = -1;     \
+        return (value);      \
+    } while (0)
+
+// The walk's last statement runs on into 'default' on purpose
+#define CO_END(co, value)            \
+    __attribute__((fallthrough));    \
+    default:                         \
+        (co)->line = -1;             \
+    }                                \
+    return (value)
+
+#endif
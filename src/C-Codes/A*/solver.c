@@ -1,12 +1,18 @@
 // solver.c - A* Pathfinding Algorithm
 // Explores maze using DFS, stops when goal is found
-#include "solver.h"
+#include "strategy.h"
 #include "API.h"
+#include "capture.h"
+#include "coroutine.h"
+#include "log.h"
+#include "maze.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#ifndef MAX_SIZE
 #define MAX_SIZE 16
+#endif
 #define INF 9999
 
 // Direction vectors
@@ -25,14 +31,15 @@ static char walls[MAX_SIZE][MAX_SIZE][4];
 static char visited[MAX_SIZE][MAX_SIZE];
 
 // DFS stack
-static int stackX[256];
-static int stackY[256];
+static int stackX[MAX_SIZE * MAX_SIZE];
+static int stackY[MAX_SIZE * MAX_SIZE];
 static int stackSize = 0;
 
 // Goal cells
 static int goalX[4];
 static int goalY[4];
 static int goalFound = 0;
+static int cellsExplored = 0;
 
 // State
 typedef enum {
@@ -40,14 +47,17 @@ typedef enum {
     STATE_COMPLETE
 } State;
 static State state = STATE_EXPLORE;
-static int waitingForMove = 0;
+static int tooLarge = 0;
+static Coroutine walk;  // explorePhase's resume point
 
-void initMaze() {
-    static int initialized = 0;
-    if (initialized) return;
-    
+static void initMaze() {
     mazeWidth = API_mazeWidth();
     mazeHeight = API_mazeHeight();
+    if (mazeWidth > MAX_SIZE || mazeHeight > MAX_SIZE) {
+        log_error("Maze %dx%d is larger than MAX_SIZE %d", mazeWidth, mazeHeight, MAX_SIZE);
+        tooLarge = 1;
+        return;
+    }
     
     memset(walls, 0, sizeof(walls));
     memset(visited, 0, sizeof(visited));
@@ -64,15 +74,11 @@ void initMaze() {
     stackY[0] = 0;
     stackSize = 1;
     
-    char msg[64];
-    sprintf(msg, "Maze: %dx%d", mazeWidth, mazeHeight);
-    debug_log(msg);
-    debug_log("=== A* Exploration - Finding Goal ===");
-    
-    initialized = 1;
+    log_info("Maze: %dx%d", mazeWidth, mazeHeight);
+    log_info("=== A* Exploration - Finding Goal ===");
 }
 
-int isGoal(int px, int py) {
+static int isGoal(int px, int py) {
     for (int i = 0; i < 4; i++) {
         if (px == goalX[i] && py == goalY[i]) {
             return 1;
@@ -81,7 +87,7 @@ int isGoal(int px, int py) {
     return 0;
 }
 
-void senseWalls() {
+static void senseWalls() {
     if (API_wallFront()) {
         walls[y][x][direction] = 1;
     }
@@ -93,154 +99,130 @@ void senseWalls() {
     }
 }
 
-void turnToDirection(int targetDir) {
-    while (direction != targetDir) {
-        int diff = (targetDir - direction + 4) % 4;
-        if (diff == 1) {
-            API_turnRight();
-            direction = (direction + 1) % 4;
-        } else if (diff == 3) {
-            API_turnLeft();
-            direction = (direction + 3) % 4;
-        } else {
-            API_turnRight();
-            API_turnRight();
-            direction = (direction + 2) % 4;
+// DFS walk written straight through: each FORWARD is yielded to main.c and
+// the walk picks up here, on the next call, once the move has been sent
+static Action explorePhase() {
+    static int d;
+
+    CO_BEGIN(&walk);
+    while (1) {
+        // Process current cell
+        log_debug("[PROCESS] At (%d,%d) dir=%d, cells=%d", x, y, direction, cellsExplored);
+
+        API_setColor(x, y, 'Y');
+        visited[y][x] = 1;
+        cellsExplored++;
+
+        senseWalls();
+        log_debug("[WALLS] Front=%d Left=%d Right=%d", walls[y][x][direction],
+                  walls[y][x][(direction + 3) % 4], walls[y][x][(direction + 1) % 4]);
+
+        if (!goalFound && isGoal(x, y)) {
+            goalFound = 1;
+            log_info("Goal found at (%d, %d) after exploring %d cells", x, y, cellsExplored);
+            for (int i = 0; i < 4; i++) {
+                API_setColor(goalX[i], goalY[i], 'R');
+            }
+            char text[32];
+            sprintf(text, "%d cells", cellsExplored);
+            API_setText(x, y, text);
+            log_info("=== Goal found - A* exploration complete ===");
+            state = STATE_COMPLETE;
+            CO_RETURN(&walk, IDLE);
         }
-    }
-}
 
-Action explorePhase() {
-    static int cellsExplored = 0;
-    static int moveDirection = -1;  // Track which direction we're moving
-    static int isBacktracking = 0;  // Track if we're in backtrack mode
-    
-    // If waiting for move to complete
-    if (waitingForMove) {
-        char msg[128];
-        sprintf(msg, "[MOVE] Move completed! Now updating position (%d,%d) -> (%d,%d) via dir=%d %s", 
-                x, y, x + dx[moveDirection], y + dy[moveDirection], moveDirection,
-                isBacktracking ? "(BACKTRACK)" : "");
-        debug_log(msg);
-        
-        x += dx[moveDirection];
-        y += dy[moveDirection];
-        
-        if (!isBacktracking) {
-            // Only add to stack if moving forward
+        // Try unvisited neighbor
+        log_debug("[SEARCH] Looking for unvisited neighbors...");
+        for (d = 0; d < 4; d++) {
+            int nx = x + dx[d];
+            int ny = y + dy[d];
+
+            log_debug("[SEARCH] Dir %d (%s): next=(%d,%d) visited=%d wall=%d", 
+                      d, (d==0?"N":d==1?"E":d==2?"S":"W"), 
+                      nx, ny, 
+                      (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight) ? visited[ny][nx] : -1, 
+                      walls[y][x][d]);
+
+            if (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight &&
+                !visited[ny][nx] && !walls[y][x][d]) {
+                break;
+            }
+        }
+
+        if (d < 4) {
+            log_debug("[DECIDE] Moving to (%d,%d) dir=%d", x + dx[d], y + dy[d], d);
+            maze_turn_to(&direction, d);
+            CO_YIELD(&walk, FORWARD);
+
+            x += dx[d];
+            y += dy[d];
             stackX[stackSize] = x;
             stackY[stackSize] = y;
             stackSize++;
+            continue;
         }
-        
-        waitingForMove = 0;
-        moveDirection = -1;
-        isBacktracking = 0;
-        
-        return IDLE;  // Let next call process the new cell
-    }
-    
-    // Process current cell
-    char msg[128];
-    sprintf(msg, "[PROCESS] At (%d,%d) dir=%d, cells=%d", x, y, direction, cellsExplored);
-    debug_log(msg);
-    
-    API_setColor(x, y, 'Y');
-    visited[y][x] = 1;
-    cellsExplored++;
-    
-    senseWalls();
-    sprintf(msg, "[WALLS] Front=%d Left=%d Right=%d", 
-            API_wallFront(), API_wallLeft(), API_wallRight());
-    debug_log(msg);
-    
-    if (!goalFound && isGoal(x, y)) {
-        goalFound = 1;
-        sprintf(msg, "Goal found at (%d, %d) after exploring %d cells", x, y, cellsExplored);
-        debug_log(msg);
-        for (int i = 0; i < 4; i++) {
-            API_setColor(goalX[i], goalY[i], 'R');
-        }
-        sprintf(msg, "%d cells", cellsExplored);
-        API_setText(x, y, msg);
-        debug_log("=== Goal found - A* exploration complete ===");
-        state = STATE_COMPLETE;
-        return IDLE;
-    }
-    
-    // Try unvisited neighbor
-    debug_log("[SEARCH] Looking for unvisited neighbors...");
-    for (int d = 0; d < 4; d++) {
-        int nx = x + dx[d];
-        int ny = y + dy[d];
-        
-        sprintf(msg, "[SEARCH] Dir %d (%s): next=(%d,%d) visited=%d wall=%d", 
-                d, (d==0?"N":d==1?"E":d==2?"S":"W"), 
-                nx, ny, 
-                (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight) ? visited[ny][nx] : -1, 
-                walls[y][x][d]);
-        debug_log(msg);
-        
-        if (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight &&
-            !visited[ny][nx] && !walls[y][x][d]) {
-            
-            sprintf(msg, "[DECIDE] Moving to (%d,%d) dir=%d", nx, ny, d);
-            debug_log(msg);
-            
-            turnToDirection(d);
-            sprintf(msg, "[TURN] Now facing dir=%d", direction);
-            debug_log(msg);
-            
-            moveDirection = d;  // Remember which direction we're moving
-            waitingForMove = 1;
-            debug_log("[RETURN] Returning FORWARD - will update position next call");
-            return FORWARD;
-        }
-    }
-    
-    // Backtrack
-    debug_log("[BACKTRACK] No unvisited neighbors, backtracking...");
-    if (stackSize > 1) {
-        // Current cell is at stackSize - 1
-        // Previous cell is at stackSize - 2
+
+        // Backtrack
+        log_debug("[BACKTRACK] No unvisited neighbors, backtracking...");
+        if (stackSize <= 1)
+            break;
+
+        // Current cell is at stackSize - 1, previous cell at stackSize - 2
         int prevX = stackX[stackSize - 2];
         int prevY = stackY[stackSize - 2];
-        
-        sprintf(msg, "[BACKTRACK] Stack size=%d, current=(%d,%d), going to (%d,%d)", 
-                stackSize, stackX[stackSize-1], stackY[stackSize-1], prevX, prevY);
-        debug_log(msg);
-        
-        // Pop current cell from stack
+        log_debug("[BACKTRACK] Stack size=%d, current=(%d,%d), going to (%d,%d)", 
+                  stackSize, x, y, prevX, prevY);
         stackSize--;
-        
-        for (int d = 0; d < 4; d++) {
-            if (x + dx[d] == prevX && y + dy[d] == prevY) {
-                sprintf(msg, "[BACKTRACK] Found dir=%d to prev cell", d);
-                debug_log(msg);
-                
-                turnToDirection(d);
-                moveDirection = d;
-                isBacktracking = 1;  // Mark that we're backtracking
-                waitingForMove = 1;
-                return FORWARD;
-            }
+
+        for (d = 0; d < 4; d++) {
+            if (x + dx[d] == prevX && y + dy[d] == prevY)
+                break;
         }
+        if (d == 4)
+            break;
+
+        maze_turn_to(&direction, d);
+        CO_YIELD(&walk, FORWARD);
+
+        x += dx[d];
+        y += dy[d];
     }
-    
+
     // Exploration complete
-    sprintf(msg, "Exploration complete: %d steps (stack size: %d)", cellsExplored, stackSize);
-    debug_log(msg);
-    
+    log_info("Exploration complete: %d steps (stack size: %d)", cellsExplored, stackSize);
+
+    state = STATE_COMPLETE;
     if (!goalFound) {
-        debug_log("ERROR: Goal not found!");
+        log_error("ERROR: Goal not found!");
+        CO_RETURN(&walk, GIVE_UP);
     }
+
+    CO_END(&walk, IDLE);
+}
+
+// Snapshot pose and sensed walls for MMS_CAPTURE (no distance field here)
+static void captureState() {
+    static int calls = 0;
+    calls++;
+    CaptureCell* cells = capture_cells(mazeWidth, mazeHeight);
+    if (!cells)
+        return;
     
-    state = STATE_COMPLETE;
-    return IDLE;
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            int wallBits = 0;
+            for (int d = 0; d < 4; d++)
+                wallBits |= walls[j][i][d] << d;
+            capture_set(&cells[j * mazeWidth + i], -1, wallBits, visited[j][i] ? 0x0F : 0);
+        }
+    }
+    capture_frame(calls, x, y, direction);
 }
 
-Action solver() {
-    initMaze();
+static Action aStarStep() {
+    if (tooLarge)
+        return GIVE_UP;
+    captureState();
     
     switch (state) {
         case STATE_EXPLORE:
@@ -253,14 +235,31 @@ Action solver() {
     return IDLE;
 }
 
-Action floodFill() {
-    return IDLE;
+static int aStarStats(char* buffer, int size) {
+    return snprintf(buffer, size, "cells=%d goal=%d", cellsExplored, goalFound);
 }
 
-Action leftWallFollower() {
-    return IDLE;
+// Back at the start: walk the DFS again from scratch. The walls sensed so
+// far stay, they are still true; visited marks and the stack do not.
+static void aStarReset() {
+    x = 0;
+    y = 0;
+    direction = 0;
+    memset(visited, 0, sizeof(visited));
+    stackX[0] = 0;
+    stackY[0] = 0;
+    stackSize = 1;
+    goalFound = 0;
+    cellsExplored = 0;
+    state = STATE_EXPLORE;
+    walk.line = 0;
 }
 
-Action rightWallFollower() {
-    return IDLE;
-}
\ No newline at end of file
+const Strategy astar_strategy = {
+    "astar",
+    "depth-first exploration until the goal is found",
+    initMaze,
+    aStarStep,
+    aStarReset,
+    aStarStats,
+};
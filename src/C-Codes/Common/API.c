@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "API.h"
+#include "capture.h"
+#include "log.h"
+#include "profile.h"
+#include "protocol.h"
+#include "shm.h"
+#include "trace.h"
+#include "vis.h"
+
+#define BUFFER_SIZE 32
+
+// Moves made so far; rate-limited display refreshes are spaced in moves
+static int moves = 0;
+
+// 1 once the simulator has accepted the binary protocol (see protocol.h);
+// the shared-memory transport always speaks it
+static int binary = -1;
+
+// Text handshake of protocol.h; returns 1 if the simulator switched to binary
+static int negotiate_binary() {
+    char line[BUFFER_SIZE];
+    vis_query("mazeWidth\nmazeHeight");
+    int width = fgets(line, sizeof(line), stdin) ? atoi(line) : 0;
+    int height = fgets(line, sizeof(line), stdin) ? atoi(line) : 0;
+    if (width > 255 || height > 255) {
+        log_warn("Maze %dx%d does not fit the binary protocol, staying on text", width, height);
+        return 0;
+    }
+
+    char hello[BUFFER_SIZE];
+    snprintf(hello, sizeof(hello), "%s %d\nmazeWidth", PROTO_HELLO, PROTO_VERSION);
+    vis_query(hello);
+    if (!fgets(line, sizeof(line), stdin))
+        return 0;
+    int length = strlen(PROTO_HELLO);
+    int accepted = strncmp(line, PROTO_HELLO, length) == 0 &&
+                   atoi(line + length) == PROTO_VERSION;
+    // A number is the width: the offer was ignored. Anything else answered
+    // the offer, and the width follows.
+    if (accepted || line[0] < '0' || line[0] > '9')
+        fgets(line, sizeof(line), stdin);
+    return accepted;
+}
+
+static int use_binary() {
+    if (binary < 0) {
+        binary = 0;
+        const char* offer = getenv("MMS_PROTOCOL");
+        if (shm_enabled())
+            binary = 1;
+        else if (offer && strcmp(offer, "binary") == 0)
+            binary = negotiate_binary();
+    }
+    return binary;
+}
+
+#ifndef HEADLESS
+
+static void send_frame(const void* data, int length) {
+    if (shm_enabled())
+        shm_frame(data, length);
+    else
+        vis_frame(data, length);
+}
+
+// Queue a display command as a binary frame: op, x, y and an optional char
+static void send_cell_frame(unsigned char op, int x, int y, char arg, int has_arg) {
+    unsigned char frame[4] = {op, (unsigned char)x, (unsigned char)y, (unsigned char)arg};
+    send_frame(frame, has_arg ? 4 : 3);
+}
+
+#ifndef MAX_SIZE
+#define MAX_SIZE 16
+#endif
+#define SHADOW_TEXT_SIZE 16
+
+// Shadow of what the simulator currently shows. Display commands that would
+// not change it are dropped before they reach the trace or the simulator.
+// Cells outside MAX_SIZE and longer texts are not tracked and always sent;
+// they count as shown so the next clear-all command is never skipped.
+static char shadow_color[MAX_SIZE][MAX_SIZE];                   // 0 = none
+static char shadow_text[MAX_SIZE][MAX_SIZE][SHADOW_TEXT_SIZE];  // "" = none
+static unsigned char shadow_walls[MAX_SIZE][MAX_SIZE];          // bit d = wall on side d
+static int colored_cells = 0;
+static int text_cells = 0;
+
+static int in_shadow(int x, int y) {
+    return x >= 0 && x < MAX_SIZE && y >= 0 && y < MAX_SIZE;
+}
+
+// Returns 1 if showing (set) or hiding the wall changes the display
+static int shadow_wall(int x, int y, char direction, int set) {
+    static const char* sides = "nesw";
+    static const int dx[] = {0, 1, 0, -1};
+    static const int dy[] = {1, 0, -1, 0};
+    const char* side = strchr(sides, direction | 0x20);
+    if (!side || !in_shadow(x, y))
+        return 1;
+
+    int d = side - sides;
+    if (((shadow_walls[x][y] >> d) & 1) == set)
+        return 0;
+    shadow_walls[x][y] ^= 1 << d;
+
+    // The simulator shows the same wall from the neighbouring cell
+    int nx = x + dx[d];
+    int ny = y + dy[d];
+    if (in_shadow(nx, ny)) {
+        int opposite = (d + 2) % 4;
+        shadow_walls[nx][ny] = (shadow_walls[nx][ny] & ~(1 << opposite)) | (set << opposite);
+    }
+    return 1;
+}
+
+// Returns 1 if the cell's color changes (color 0 clears it)
+static int shadow_color_cell(int x, int y, char color) {
+    if (!in_shadow(x, y)) {
+        colored_cells++;
+        return 1;
+    }
+    char old = shadow_color[x][y];
+    if (old == color)
+        return 0;
+    colored_cells += (color != 0) - (old != 0);
+    shadow_color[x][y] = color;
+    return 1;
+}
+
+// Returns 1 if the cell's text changes (NULL or "" clears it)
+static int shadow_text_cell(int x, int y, const char* text) {
+    if (!in_shadow(x, y)) {
+        text_cells++;
+        return 1;
+    }
+    char* old = shadow_text[x][y];
+    if (!text)
+        text = "";
+    size_t length = strlen(text);
+    if (length < SHADOW_TEXT_SIZE && strcmp(old, text) == 0)
+        return 0;
+
+    text_cells += (length > 0) - (old[0] != 0);
+    if (length < SHADOW_TEXT_SIZE) {
+        memcpy(old, text, length + 1);
+    } else {
+        // Too long to compare later: keep a marker that never matches
+        old[0] = '\x7f';
+        old[1] = '\0';
+    }
+    return 1;
+}
+
+#endif  // HEADLESS
+
+// Binary requests are the opcode alone, answered with a single byte
+static void send_request(unsigned char op, char* command) {
+    if (!use_binary())
+        vis_query(command);
+    else if (shm_enabled())
+        shm_send(&op, 1);
+    else
+        vis_query_frame(&op, 1);
+}
+
+// Reply to the last request: the byte in binary mode, else 0 with the text
+// line in 'response'
+static int get_reply(char* response) {
+    if (!use_binary()) {
+        if (!fgets(response, BUFFER_SIZE, stdin))
+            response[0] = '\0';
+        return 0;
+    }
+    if (shm_enabled())
+        return shm_reply();
+    int reply = getchar();
+    return reply == EOF ? 0 : reply;
+}
+
+static void finish_moves();
+
+int getInteger(unsigned char op, char* command) {
+    char response[BUFFER_SIZE];
+    send_request(op, command);
+    finish_moves();
+    int reply = get_reply(response);
+    if (use_binary())
+        return reply;
+    int value = atoi(response);
+    return value;
+}
+
+int getBoolean(unsigned char op, char* command) {
+    char response[BUFFER_SIZE];
+    send_request(op, command);
+    finish_moves();
+    int reply = get_reply(response);
+    if (use_binary())
+        return reply == 1;
+    int value = (strcmp(response, "true\n") == 0);
+    return value;
+}
+
+int receiveAck() {
+    char response[BUFFER_SIZE];
+    int reply = get_reply(response);
+    if (use_binary())
+        return reply == 1;
+    int success = (strcmp(response, "ack\n") == 0);
+    return success;
+}
+
+int getAck(unsigned char op, char* command) {
+    send_request(op, command);
+    finish_moves();
+    return receiveAck();
+}
+
+int API_mazeWidth() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getInteger(PROTO_MAZE_WIDTH, "mazeWidth");
+    trace_query(TRACE_MAZE_WIDTH, result, start);
+    profile_io(PROFILE_SENSE, "mazeWidth", io_start);
+    return result;
+}
+
+int API_mazeHeight() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getInteger(PROTO_MAZE_HEIGHT, "mazeHeight");
+    trace_query(TRACE_MAZE_HEIGHT, result, start);
+    profile_io(PROFILE_SENSE, "mazeHeight", io_start);
+    return result;
+}
+
+int API_wallFront() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getBoolean(PROTO_WALL_FRONT, "wallFront");
+    trace_query(TRACE_WALL_FRONT, result, start);
+    profile_io(PROFILE_SENSE, "wallFront", io_start);
+    return result;
+}
+
+int API_wallRight() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getBoolean(PROTO_WALL_RIGHT, "wallRight");
+    trace_query(TRACE_WALL_RIGHT, result, start);
+    profile_io(PROFILE_SENSE, "wallRight", io_start);
+    return result;
+}
+
+int API_wallLeft() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getBoolean(PROTO_WALL_LEFT, "wallLeft");
+    trace_query(TRACE_WALL_LEFT, result, start);
+    profile_io(PROFILE_SENSE, "wallLeft", io_start);
+    return result;
+}
+
+// moveForward requests sent but not yet acknowledged, oldest first. Replies
+// come back in request order, so any later query first collects these acks.
+#define MAX_PENDING_MOVES 8
+static uint64_t move_io_start[MAX_PENDING_MOVES];
+static TraceEvent* move_trace[MAX_PENDING_MOVES];
+static int moves_sent = 0;
+static int moves_acked = 0;
+static int last_move_result = 1;
+
+void API_moveForwardStart() {
+    if (moves_sent - moves_acked == MAX_PENDING_MOVES)
+        API_moveForwardFinish();
+    int slot = moves_sent % MAX_PENDING_MOVES;
+    move_io_start[slot] = profile_now();
+    move_trace[slot] = trace_begin(TRACE_MOVE_FORWARD, trace_now());
+    send_request(PROTO_MOVE_FORWARD, "moveForward");
+    moves_sent++;
+}
+
+int API_moveForwardFinish() {
+    if (moves_acked == moves_sent)
+        return last_move_result;
+    int slot = moves_acked % MAX_PENDING_MOVES;
+    int result = receiveAck();
+    moves_acked++;
+    moves++;
+    trace_end(move_trace[slot], result);
+    profile_io(PROFILE_MOTION, "moveForward", move_io_start[slot]);
+    last_move_result = result;
+    return result;
+}
+
+static void finish_moves() {
+    while (moves_acked < moves_sent)
+        API_moveForwardFinish();
+}
+
+int API_moveForward() {
+    API_moveForwardStart();
+    finish_moves();
+    return last_move_result;
+}
+
+void API_turnRight() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    getAck(PROTO_TURN_RIGHT, "turnRight");
+    trace_query(TRACE_TURN_RIGHT, 1, start);
+    profile_io(PROFILE_MOTION, "turnRight", io_start);
+}
+
+void API_turnLeft() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    getAck(PROTO_TURN_LEFT, "turnLeft");
+    trace_query(TRACE_TURN_LEFT, 1, start);
+    profile_io(PROFILE_MOTION, "turnLeft", io_start);
+}
+
+#ifndef HEADLESS
+
+void API_setWall(int x, int y, char direction) {
+    if (capture_enabled() || !shadow_wall(x, y, direction, 1))
+        return;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_SET_WALL, x, y, direction);
+    if (use_binary())
+        send_cell_frame(PROTO_SET_WALL, x, y, direction, 1);
+    else
+        vis_command("setWall %d %d %c", x, y, direction);
+    profile_io(PROFILE_DISPLAY, "setWall", io_start);
+}
+
+void API_clearWall(int x, int y, char direction) {
+    if (capture_enabled() || !shadow_wall(x, y, direction, 0))
+        return;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_CLEAR_WALL, x, y, direction);
+    if (use_binary())
+        send_cell_frame(PROTO_CLEAR_WALL, x, y, direction, 1);
+    else
+        vis_command("clearWall %d %d %c", x, y, direction);
+    profile_io(PROFILE_DISPLAY, "clearWall", io_start);
+}
+
+void API_setColor(int x, int y, char color) {
+    if (capture_enabled() || !shadow_color_cell(x, y, color))
+        return;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_SET_COLOR, x, y, color);
+    if (use_binary())
+        send_cell_frame(PROTO_SET_COLOR, x, y, color, 1);
+    else
+        vis_command("setColor %d %d %c", x, y, color);
+    profile_io(PROFILE_DISPLAY, "setColor", io_start);
+}
+
+void API_clearColor(int x, int y) {
+    if (capture_enabled() || !shadow_color_cell(x, y, 0))
+        return;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_CLEAR_COLOR, x, y, 0);
+    if (use_binary())
+        send_cell_frame(PROTO_CLEAR_COLOR, x, y, 0, 0);
+    else
+        vis_command("clearColor %d %d", x, y);
+    profile_io(PROFILE_DISPLAY, "clearColor", io_start);
+}
+
+void API_clearAllColor() {
+    if (capture_enabled() || colored_cells == 0)
+        return;
+    memset(shadow_color, 0, sizeof(shadow_color));
+    colored_cells = 0;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_CLEAR_ALL_COLOR, 0, 0, 0);
+    if (use_binary())
+        send_frame((unsigned char[]){PROTO_CLEAR_ALL_COLOR}, 1);
+    else
+        vis_command("clearAllColor");
+    profile_io(PROFILE_DISPLAY, "clearAllColor", io_start);
+}
+
+void API_setText(int x, int y, char* text) {
+    if (capture_enabled() || !shadow_text_cell(x, y, text))
+        return;
+    uint64_t io_start = profile_now();
+    trace_text(TRACE_SET_TEXT, x, y, text);
+    if (use_binary()) {
+        unsigned char frame[4 + PROTO_TEXT_MAX] = {PROTO_SET_TEXT, (unsigned char)x, (unsigned char)y};
+        size_t length = strlen(text);
+        frame[3] = length < PROTO_TEXT_MAX ? length : PROTO_TEXT_MAX;
+        memcpy(frame + 4, text, frame[3]);
+        send_frame(frame, 4 + frame[3]);
+    } else {
+        vis_command("setText %d %d %s", x, y, text);
+    }
+    profile_io(PROFILE_DISPLAY, "setText", io_start);
+}
+
+void API_clearText(int x, int y) {
+    if (capture_enabled() || !shadow_text_cell(x, y, NULL))
+        return;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_CLEAR_TEXT, x, y, 0);
+    if (use_binary())
+        send_cell_frame(PROTO_CLEAR_TEXT, x, y, 0, 0);
+    else
+        vis_command("clearText %d %d", x, y);
+    profile_io(PROFILE_DISPLAY, "clearText", io_start);
+}
+
+void API_clearAllText() {
+    if (capture_enabled() || text_cells == 0)
+        return;
+    memset(shadow_text, 0, sizeof(shadow_text));
+    text_cells = 0;
+    uint64_t io_start = profile_now();
+    trace_command(TRACE_CLEAR_ALL_TEXT, 0, 0, 0);
+    if (use_binary())
+        send_frame((unsigned char[]){PROTO_CLEAR_ALL_TEXT}, 1);
+    else
+        vis_command("clearAllText");
+    profile_io(PROFILE_DISPLAY, "clearAllText", io_start);
+}
+
+// MMS_DISPLAY_EVERY=N spaces refreshes at least N moves apart (default 1);
+// nothing is displayed live while MMS_CAPTURE records frames
+int API_displayDue(int* lastRefresh) {
+    static int every = 0;
+    if (every == 0) {
+        const char* value = getenv("MMS_DISPLAY_EVERY");
+        every = value && atoi(value) > 0 ? atoi(value) : 1;
+    }
+    if (capture_enabled())
+        return 0;
+    if (every > 1 && *lastRefresh >= 0 && moves - *lastRefresh < every)
+        return 0;
+    *lastRefresh = moves;
+    return 1;
+}
+
+#endif  // HEADLESS
+
+int API_wasReset() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    int result = getBoolean(PROTO_WAS_RESET, "wasReset");
+    trace_query(TRACE_WAS_RESET, result, start);
+    profile_io(PROFILE_SENSE, "wasReset", io_start);
+    return result;
+}
+
+void API_ackReset() {
+    uint64_t io_start = profile_now();
+    uint32_t start = trace_now();
+    getAck(PROTO_ACK_RESET, "ackReset");
+    trace_query(TRACE_ACK_RESET, 1, start);
+    profile_io(PROFILE_MOTION, "ackReset", io_start);
+}
+
+void debug_log(char* text) {
+    trace_text(TRACE_DEBUG_LOG, 0, 0, text);
+    log_text(text);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+int API_mazeWidth();
+int API_mazeHeight();
+
+int API_wallFront();
+int API_wallRight();
+int API_wallLeft();
+
+int API_moveForward();  // Returns 0 if crash, else returns 1
+
+// API_moveForward in two halves: send the request, do other work while the
+// simulator moves the mouse, then collect the ack. Up to 8 moves may be in
+// flight; Finish returns the oldest one's result, and any other query
+// collects all outstanding acks first (their results are then lost).
+void API_moveForwardStart();
+int API_moveForwardFinish();
+void API_turnRight();
+void API_turnLeft();
+
+#ifdef HEADLESS
+
+// Headless build (-DHEADLESS): display calls and their arguments compile away
+#define API_setWall(x, y, direction) ((void)0)
+#define API_clearWall(x, y, direction) ((void)0)
+
+#define API_setColor(x, y, color) ((void)0)
+#define API_clearColor(x, y) ((void)0)
+#define API_clearAllColor() ((void)0)
+
+#define API_setText(x, y, str) ((void)0)
+#define API_clearText(x, y) ((void)0)
+#define API_clearAllText() ((void)0)
+
+#define API_displayDue(lastRefresh) ((void)(lastRefresh), 0)
+
+#else
+
+void API_setWall(int x, int y, char direction);
+void API_clearWall(int x, int y, char direction);
+
+void API_setColor(int x, int y, char color);
+void API_clearColor(int x, int y);
+void API_clearAllColor();
+
+void API_setText(int x, int y, char* str);
+void API_clearText(int x, int y);
+void API_clearAllText();
+
+// 1 if a rate-limited display refresh (e.g. distance labels) should run now;
+// 'lastRefresh' starts at -1 and is updated when it returns 1
+int API_displayDue(int* lastRefresh);
+
+#endif
+
+int API_wasReset();
+void API_ackReset();
+
+void debug_log(char* text);
\ No newline at end of file
@@ -0,0 +1,150 @@
+// capture.c - Per-step solver state recorder
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int state = 0;  // 0 = not checked yet, 1 = off, 2 = recording
+static FILE* file = NULL;
+static int width = 0;
+static int height = 0;
+static CaptureCell* cells = NULL;     // filled by the solver
+static CaptureCell* previous = NULL;  // last written frame
+static unsigned char* payload = NULL;
+static int frames = 0;
+static int last_x = -1;
+static int last_y = -1;
+static int last_heading = -1;
+
+static void put_u16(unsigned char* p, unsigned value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(unsigned char* p, uint32_t value) {
+    put_u16(p, value & 0xFFFF);
+    put_u16(p + 2, value >> 16);
+}
+
+static int put_varint(unsigned char* p, uint32_t value) {
+    int n = 0;
+    while (value >= 0x80) {
+        p[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (unsigned char)value;
+    return n;
+}
+
+static void capture_close() {
+    if (file) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+static void capture_open() {
+    state = 1;
+    const char* path = getenv("MMS_CAPTURE");
+    if (!path || !*path)
+        return;
+
+    file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "capture: cannot write %s\n", path);
+        return;
+    }
+    atexit(capture_close);
+    state = 2;
+}
+
+int capture_enabled() {
+    if (state == 0)
+        capture_open();
+    return state == 2;
+}
+
+CaptureCell* capture_cells(int w, int h) {
+    if (!capture_enabled())
+        return NULL;
+    if (cells)
+        return w == width && h == height ? cells : NULL;
+
+    // Dimensions are fixed by the first call, which also writes the header
+    size_t bytes = (size_t)w * h * sizeof(CaptureCell);
+    cells = calloc(1, bytes);
+    previous = calloc(1, bytes);
+    payload = malloc(bytes * 2 + 16);
+    if (!cells || !previous || !payload) {
+        state = 1;
+        return NULL;
+    }
+    width = w;
+    height = h;
+
+    unsigned char header[9] = {'M', 'M', 'C', 'F', CAPTURE_VERSION};
+    put_u16(header + 5, width);
+    put_u16(header + 7, height);
+    fwrite(header, 1, sizeof(header), file);
+    return cells;
+}
+
+void capture_set(CaptureCell* cell, int distance, int walls, int known) {
+    unsigned value = distance < 0 || distance >= CAPTURE_UNKNOWN ? CAPTURE_UNKNOWN : distance;
+    cell->distance_lo = value & 0xFF;
+    cell->distance_hi = value >> 8;
+    cell->walls = walls;
+    cell->known = known;
+}
+
+void capture_frame(int step, int x, int y, int heading) {
+    if (state != 2 || !cells)
+        return;
+
+    size_t bytes = (size_t)width * height * sizeof(CaptureCell);
+    int key = frames % CAPTURE_KEY_INTERVAL == 0;
+    if (!key && x == last_x && y == last_y && heading == last_heading &&
+        memcmp(cells, previous, bytes) == 0)
+        return;
+
+    // XOR against the previous frame and run-length encode the zero bytes
+    const unsigned char* now = (const unsigned char*)cells;
+    const unsigned char* before = (const unsigned char*)previous;
+    size_t used = 0;
+    size_t i = 0;
+    while (i < bytes) {
+        size_t zeros = 0;
+        while (i + zeros < bytes && (key ? now[i + zeros] : now[i + zeros] ^ before[i + zeros]) == 0)
+            zeros++;
+        size_t literals = 0;
+        while (i + zeros + literals < bytes &&
+               (key ? now[i + zeros + literals]
+                    : now[i + zeros + literals] ^ before[i + zeros + literals]) != 0)
+            literals++;
+
+        used += put_varint(payload + used, zeros);
+        used += put_varint(payload + used, literals);
+        for (size_t j = 0; j < literals; j++) {
+            size_t k = i + zeros + j;
+            payload[used++] = key ? now[k] : now[k] ^ before[k];
+        }
+        i += zeros + literals;
+    }
+
+    unsigned char header[14];
+    put_u32(header, step);
+    put_u16(header + 4, x);
+    put_u16(header + 6, y);
+    header[8] = heading;
+    header[9] = key;
+    put_u32(header + 10, used);
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(payload, 1, used, file);
+    fflush(file);  // frames stay readable if the simulator kills the solver
+
+    memcpy(previous, cells, bytes);
+    last_x = x;
+    last_y = y;
+    last_heading = heading;
+    frames++;
+}
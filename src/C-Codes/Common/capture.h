@@ -0,0 +1,39 @@
+#pragma once
+
+// Offline capture of what the solver knows at every step.
+// Set MMS_CAPTURE=<file> to record one frame per step (pose, distance field,
+// known walls) instead of streaming display commands to the simulator; render
+// the file afterwards with Tools/render.
+//
+// File: "MMCF" + version byte + uint16 width + uint16 height, then frames:
+//   uint32 step, uint16 x, uint16 y, uint8 heading, uint8 flags (bit 0 = key
+//   frame), uint32 payload size, payload
+// All integers are little endian. A frame's cells are width*height CaptureCells
+// in row-major order (y * width + x). The payload is that array XORed with the
+// previous frame (zeros for key frames), stored as runs of
+// varint zero count, varint literal count, literal bytes.
+// Frames identical to the previous one are not written.
+
+#include <stdint.h>
+
+#define CAPTURE_VERSION 1
+#define CAPTURE_KEY_INTERVAL 64
+#define CAPTURE_UNKNOWN 0xFFFF  // distance not known / unreachable
+
+typedef struct {
+    uint8_t distance_lo;
+    uint8_t distance_hi;
+    uint8_t walls;  // bit d = wall on side d (0=N, 1=E, 2=S, 3=W)
+    uint8_t known;  // bit d = side d has been sensed
+} CaptureCell;
+
+// 1 while recording; the API drops live display commands then
+int capture_enabled();
+
+// Cell array the solver fills before capture_frame (NULL when not recording)
+CaptureCell* capture_cells(int width, int height);
+
+void capture_set(CaptureCell* cell, int distance, int walls, int known);
+
+// Record the filled cells with the mouse pose after 'step' driver steps
+void capture_frame(int step, int x, int y, int heading);
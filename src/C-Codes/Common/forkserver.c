@@ -0,0 +1,81 @@
+// forkserver.c - One process start-up for many episodes (see forkserver.h)
+#include "forkserver.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Reads one episode request; returns the number of descriptors attached
+// (0 or 2), or -1 once the harness has gone away
+static int receive_episode(int control, int fds[2]) {
+    uint32_t episode;
+    struct iovec data = {&episode, sizeof(episode)};
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(2 * sizeof(int))];
+    } control_data;
+    struct msghdr message = {0};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control_data.space;
+    message.msg_controllen = sizeof(control_data.space);
+
+    if (recvmsg(control, &message, 0) != sizeof(episode))
+        return -1;
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (!header || header->cmsg_type != SCM_RIGHTS ||
+        header->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+        return 0;
+    memcpy(fds, CMSG_DATA(header), 2 * sizeof(int));
+    return 2;
+}
+
+static void send_word(int control, uint32_t value) {
+    if (write(control, &value, sizeof(value)) != sizeof(value))
+        exit(0);
+}
+
+void forkserver_run() {
+    const char* value = getenv("MMS_FORK_SERVER");
+    if (!value)
+        return;
+    int control = atoi(value);
+    unsetenv("MMS_FORK_SERVER");
+    send_word(control, FORK_SERVER_HELLO);
+
+    while (1) {
+        int fds[2];
+        int attached = receive_episode(control, fds);
+        if (attached < 0)
+            exit(0);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(control);
+            if (attached) {
+                dup2(fds[0], STDIN_FILENO);
+                dup2(fds[1], STDOUT_FILENO);
+                close(fds[0]);
+                close(fds[1]);
+            }
+            return;
+        }
+
+        if (attached) {
+            close(fds[0]);
+            close(fds[1]);
+        }
+        send_word(control, pid > 0 ? pid : 0);
+        if (pid > 0) {
+            int status = 0;
+            struct rusage usage = {0};
+            wait4(pid, &status, 0, &usage);
+            send_word(control, status);
+            send_word(control, usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec +
+                                   usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec);
+        }
+    }
+}
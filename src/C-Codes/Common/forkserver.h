@@ -0,0 +1,21 @@
+#pragma once
+
+// Fork server for batch runs (Tools/headless -f).
+// When MMS_FORK_SERVER=<fd> names a Unix stream socket, forkserver_run()
+// turns the process into a server that forks one fresh solver per episode,
+// so exec, dynamic linking and libc start-up are paid once per batch. The
+// server touches no solver or API state before forking, so every child
+// starts from clean static globals and runs main() as usual.
+//
+// Server -> harness: uint32 FORK_SERVER_HELLO once ready.
+// Harness -> server: uint32 episode number, with the episode's stdin and
+//   stdout attached as SCM_RIGHTS (none: the child keeps the server's).
+// Server -> harness: uint32 child pid (0 if fork failed), then the uint32
+//   wait status and the uint32 CPU time (user + system, microseconds) once
+//   the child exits. The harness stops a child with a signal.
+// The server exits when the socket closes.
+
+#define FORK_SERVER_HELLO 0x56525346  // "FSRV"
+
+// Returns at once without MMS_FORK_SERVER; otherwise returns only in a child
+void forkserver_run();
@@ -0,0 +1,192 @@
+// log.c - Asynchronous stderr logger
+#include "log.h"
+#include "API.h"
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_RING_SIZE 1024  // lines, power of two
+#define LOG_LINE_SIZE 160
+#define LOG_BATCH_SIZE 16384
+
+static int state = 0;  // 0 = not started, 1 = synchronous fallback, 2 = writer running
+static char (*ring)[LOG_LINE_SIZE] = NULL;
+static atomic_uint ring_head;  // next slot the solver fills
+static atomic_uint ring_tail;  // next slot the writer drains
+static atomic_int stopping;
+static atomic_int sleeping;    // writer is (about to be) waiting on 'wake'
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static unsigned dropped = 0;
+static struct sigaction previous_int;
+static struct sigaction previous_term;
+
+static void write_all(const char* data, int length) {
+    while (length > 0) {
+        ssize_t written = write(STDERR_FILENO, data, length);
+        if (written <= 0)
+            return;
+        data += written;
+        length -= written;
+    }
+}
+
+// Lines go straight to fd 2 in batches: nothing waits in a stdio buffer for
+// a flush that a killed solver never reaches. Lines are claimed (ring_tail
+// moved past them) before they are written, so the signal handler and the
+// writer never both write the same line.
+static void* writer_main(void* arg) {
+    (void)arg;
+    static char batch[LOG_BATCH_SIZE];
+
+    // Signals are handled on the solver's threads, never mid-batch here
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    while (1) {
+        unsigned tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&ring_head, memory_order_acquire);
+
+        if (tail == head) {
+            if (atomic_load(&stopping))
+                break;
+            // Announce the sleep, then look again so a line published in
+            // between is not left waiting for the next one
+            pthread_mutex_lock(&lock);
+            atomic_store(&sleeping, 1);
+            if (atomic_load(&ring_head) == tail && !atomic_load(&stopping))
+                pthread_cond_wait(&wake, &lock);
+            atomic_store(&sleeping, 0);
+            pthread_mutex_unlock(&lock);
+            continue;
+        }
+
+        int used = 0;
+        unsigned end = tail;
+        while (end != head) {
+            const char* line = ring[end & (LOG_RING_SIZE - 1)];
+            int length = strlen(line);
+            if (used + length + 1 > LOG_BATCH_SIZE)
+                break;
+            memcpy(&batch[used], line, length);
+            batch[used + length] = '\n';
+            used += length + 1;
+            end++;
+        }
+        if (atomic_compare_exchange_strong(&ring_tail, &tail, end))
+            write_all(batch, used);
+    }
+    return NULL;
+}
+
+static void wake_writer() {
+    if (atomic_load(&sleeping)) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+// Writes the lines still queued with write(2) only, then passes the signal on
+// to whatever handled it before (profile.c's handler, or the default)
+static void on_signal(int sig) {
+    unsigned tail = atomic_load(&ring_tail);
+    unsigned head = atomic_load(&ring_head);
+    if (tail != head && atomic_compare_exchange_strong(&ring_tail, &tail, head)) {
+        for (; tail != head; tail++) {
+            const char* line = ring[tail & (LOG_RING_SIZE - 1)];
+            write_all(line, strlen(line));
+            write_all("\n", 1);
+        }
+    }
+    sigaction(sig, sig == SIGINT ? &previous_int : &previous_term, NULL);
+    raise(sig);
+}
+
+static void log_close() {
+    atomic_store(&stopping, 1);
+    pthread_mutex_lock(&lock);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+    if (dropped > 0)
+        fprintf(stderr, "log: dropped %u lines (ring full)\n", dropped);
+}
+
+static void log_start() {
+    state = 1;
+    ring = malloc(LOG_RING_SIZE * LOG_LINE_SIZE);
+    if (!ring)
+        return;
+
+    atomic_init(&ring_head, 0);
+    atomic_init(&ring_tail, 0);
+    atomic_init(&stopping, 0);
+    atomic_init(&sleeping, 0);
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0)
+        return;
+    atexit(log_close);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+    state = 2;
+}
+
+// Waits for the writer to free a slot, so the next line cannot be dropped
+static void wait_for_room() {
+    if (state == 0)
+        log_start();
+    while (state == 2 && atomic_load_explicit(&ring_head, memory_order_relaxed) -
+                             atomic_load_explicit(&ring_tail, memory_order_acquire) >=
+                         LOG_RING_SIZE) {
+        wake_writer();
+        sched_yield();
+    }
+}
+
+void log_text(const char* text) {
+    if (state == 0)
+        log_start();
+    if (state != 2) {
+        fprintf(stderr, "%s\n", text);
+        return;
+    }
+
+    unsigned head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+    if (head - tail >= LOG_RING_SIZE) {
+        dropped++;
+        return;
+    }
+
+    char* line = ring[head & (LOG_RING_SIZE - 1)];
+    strncpy(line, text, LOG_LINE_SIZE - 1);
+    line[LOG_LINE_SIZE - 1] = '\0';
+    atomic_store(&ring_head, head + 1);
+    wake_writer();
+}
+
+void log_printf(int level, const char* format, ...) {
+    char text[LOG_LINE_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (level == LOG_ERROR)
+        wait_for_room();
+    debug_log(text);
+}
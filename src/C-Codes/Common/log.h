@@ -0,0 +1,30 @@
+#pragma once
+
+// Leveled logging to stderr through a background writer thread.
+// Messages above LOG_LEVEL (default LOG_INFO, override with -DLOG_LEVEL=...)
+// are compiled out, arguments and all. The rest are formatted
+// on the caller, queued in a lock-free ring and written by the writer, so a
+// log call never waits on stderr. The writer sleeps on a condition variable
+// until a line arrives and writes straight to fd 2, unbuffered. When the ring
+// is full, lines are dropped (and counted), except errors: those wait for room.
+
+#define LOG_ERROR 1
+#define LOG_WARN 2
+#define LOG_INFO 3
+#define LOG_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_INFO
+#endif
+
+// printf-style message at a LOG_* level, also recorded by the API trace
+void log_printf(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Queue one line for the writer (debug_log ends up here)
+void log_text(const char* text);
+
+// Disabled levels are a constant-false branch: still type-checked, never emitted
+#define log_error(...) do { if (LOG_LEVEL >= LOG_ERROR) log_printf(LOG_ERROR, __VA_ARGS__); } while (0)
+#define log_warn(...) do { if (LOG_LEVEL >= LOG_WARN) log_printf(LOG_WARN, __VA_ARGS__); } while (0)
+#define log_info(...) do { if (LOG_LEVEL >= LOG_INFO) log_printf(LOG_INFO, __VA_ARGS__); } while (0)
+#define log_debug(...) do { if (LOG_LEVEL >= LOG_DEBUG) log_printf(LOG_DEBUG, __VA_ARGS__); } while (0)
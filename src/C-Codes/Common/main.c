@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strategy.h"
+#include "API.h"
+#include "forkserver.h"
+#include "log.h"
+#include "profile.h"
+
+static const Strategy* strategies[] = {
+    &astar_strategy,
+    &floodfill_strategy,
+    &floodfill_astar_strategy,
+    &left_hand_strategy,
+    &right_hand_strategy,
+};
+#define STRATEGY_COUNT (int)(sizeof(strategies) / sizeof(strategies[0]))
+
+static const Strategy* findStrategy(const char* name) {
+    for (int i = 0; i < STRATEGY_COUNT; i++) {
+        if (strcmp(strategies[i]->name, name) == 0)
+            return strategies[i];
+    }
+    return NULL;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s <algorithm> [name=value...]\n\nAlgorithms:\n", program);
+    for (int i = 0; i < STRATEGY_COUNT; i++)
+        fprintf(stderr, "  %-16s %s\n", strategies[i]->name, strategies[i]->description);
+}
+
+static void logStats(const Strategy* strategy) {
+    char buffer[256];
+    if (strategy->stats && strategy->stats(buffer, sizeof(buffer)) > 0)
+        log_info("%s: %s", strategy->name, buffer);
+}
+
+// MMS_PIPELINE=1 sends FORWARD without waiting for its ack: the solver
+// runs on while the simulator moves the mouse, and the ack is collected
+// by its next query. The result of a pipelined move is not checked.
+static int pipelineMoves() {
+    const char* value = getenv("MMS_PIPELINE");
+    return value && atoi(value) > 0;
+}
+
+// Driver shared by every solver: "<program> <algorithm> [name=value...]"
+// picks the strategy by name and hands it its parameters (strategy.h).
+// Under MMS_FORK_SERVER the process first becomes a fork server and each
+// episode continues from here in a fresh child (forkserver.h). Each step
+// acknowledges a simulator reset by resetting the strategy, then sends
+// the strategy's action; FORWARD is pipelined under MMS_PIPELINE. Giving
+// up exits with EXIT_GAVE_UP. The simulator protocol (text, binary or
+// shared memory), display throttling and MMS_CAPTURE are chosen inside
+// API.c, and profile_step_begin/end time the steps for MMS_PROFILE.
+// New solvers are added to strategies[] above.
+int main(int argc, char* argv[]) {
+    const Strategy* strategy = argc > 1 ? findStrategy(argv[1]) : NULL;
+    if (!strategy || !strategy_set_params(argc - 2, argv + 2)) {
+        usage(argv[0]);
+        return 2;
+    }
+    forkserver_run();
+    int pipeline = pipelineMoves();
+    debug_log("Running...");
+    strategy->init();
+    while (1) {
+        profile_step_begin();
+        if (strategy->reset && API_wasReset()) {
+            logStats(strategy);
+            strategy->reset();
+            API_ackReset();
+            log_info("Reset acknowledged");
+        }
+        Action nextMove = strategy->step();
+        switch(nextMove){
+            case FORWARD:
+                if (pipeline)
+                    API_moveForwardStart();
+                else
+                    API_moveForward();
+                break;
+            case LEFT:
+                API_turnLeft();
+                break;
+            case RIGHT:
+                API_turnRight();
+                break;
+            case IDLE:
+                break;
+            case GIVE_UP:
+                logStats(strategy);
+                log_error("%s gave up", strategy->name);
+                return EXIT_GAVE_UP;
+        }
+        profile_step_end();
+    }
+}
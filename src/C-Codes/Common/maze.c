@@ -0,0 +1,46 @@
+// maze.c - Maze geometry shared by the solvers
+#include "maze.h"
+#include "API.h"
+
+int maze_is_goal(int width, int height, int x, int y) {
+    int centerX = width / 2;
+    int centerY = height / 2;
+    return (x == centerX - 1 || x == centerX) && (y == centerY - 1 || y == centerY);
+}
+
+void maze_turn_to(int* heading, int target) {
+    switch ((target - *heading + 4) % 4) {
+        case 1:
+            API_turnRight();
+            break;
+        case 2:
+            API_turnRight();
+            API_turnRight();
+            break;
+        case 3:
+            API_turnLeft();
+            break;
+    }
+    *heading = target;
+}
+
+void maze_loop_reset(MazeLoop* loop) {
+    loop->x = -1;
+    loop->y = -1;
+    loop->heading = -1;
+    loop->period = 1;
+    loop->since = 0;
+}
+
+int maze_loop_check(MazeLoop* loop, int x, int y, int heading) {
+    if (x == loop->x && y == loop->y && heading == loop->heading)
+        return 1;
+    if (++loop->since >= loop->period) {
+        loop->x = x;
+        loop->y = y;
+        loop->heading = heading;
+        loop->period *= 2;
+        loop->since = 0;
+    }
+    return 0;
+}
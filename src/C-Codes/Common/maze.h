@@ -0,0 +1,26 @@
+#pragma once
+
+// maze.h - Maze geometry shared by the solvers
+
+// Goal is the 2x2 block in the centre
+int maze_is_goal(int width, int height, int x, int y);
+
+// Turns the mouse from *heading to target (0=N .. 3=W) with the fewest
+// API turns and updates *heading
+void maze_turn_to(int* heading, int target);
+
+// Cycle check for walks whose next move depends only on the pose, such as
+// wall following in a fixed maze: once a pose repeats, the walk is a loop
+// and will never reach anything it has not already reached. Brent's
+// method keeps one marked pose, re-marked at doubling intervals, so a loop
+// is caught within a few laps whatever the maze size.
+typedef struct {
+    int x, y, heading;  // marked pose
+    long period;        // steps until the mark moves on
+    long since;         // steps since it was placed
+} MazeLoop;
+
+void maze_loop_reset(MazeLoop* loop);
+
+// Call once per step with the current pose; returns 1 on a repeated pose
+int maze_loop_check(MazeLoop* loop, int x, int y, int heading);
@@ -0,0 +1,323 @@
+// profile.c - Compute vs I/O attribution and timeline export for the driver loop
+#include "profile.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PROFILE_DUMP_STEPS 1024
+#define TIMELINE_BUFFER_SIZE (1 << 20)
+#define TIMELINE_EVENT_MAX 1024     // room kept free for one formatted event
+#define SUMMARY_SIZE 2048
+#define SUB_BUCKETS 4              // per power of two
+#define BUCKETS (40 * SUB_BUCKETS)  // up to ~18 minutes in ns
+
+// Phases reported: the three I/O phases plus compute and the whole step
+#define PROFILE_COMPUTE PROFILE_IO_PHASES
+#define PROFILE_STEP (PROFILE_IO_PHASES + 1)
+#define PROFILE_PHASES (PROFILE_IO_PHASES + 2)
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t buckets[BUCKETS];
+} Histogram;
+
+static const char* phase_names[PROFILE_PHASES] = {
+    "sense", "motion", "display", "compute", "step"
+};
+
+static int state = 0;  // 0 = not checked yet, 1 = off, 2 = on
+static const char* path = NULL;  // histogram summary, NULL when not wanted
+static int timeline = -1;        // Chrome trace events, -1 when not wanted
+static char timeline_buffer[TIMELINE_BUFFER_SIZE];
+static int timeline_used = 0;    // bytes of whole events, advanced after each is formatted
+static volatile sig_atomic_t timeline_flushing = 0;
+static int timeline_events = 0;
+static uint64_t origin = 0;
+static Histogram histograms[PROFILE_PHASES];
+static uint64_t step_start = 0;
+static uint64_t step_io[PROFILE_IO_PHASES];
+static uint64_t steps = 0;
+static uint64_t nested_ns = 0;     // charged by profile_io_nested(), not yet left out
+static uint64_t nested_start = 0;  // of the enclosing call
+static struct sigaction previous_int;
+static struct sigaction previous_term;
+
+static uint64_t clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Log-linear bucket: SUB_BUCKETS slices per power of two
+static int bucket_of(uint64_t ns) {
+    if (ns < SUB_BUCKETS)
+        return (int)ns;
+    int octave = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (octave - 2)) & (SUB_BUCKETS - 1));
+    int bucket = (octave - 1) * SUB_BUCKETS + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+static uint64_t bucket_upper(int bucket) {
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    int octave = bucket / SUB_BUCKETS + 1;
+    int sub = bucket % SUB_BUCKETS;
+    return ((uint64_t)(SUB_BUCKETS + sub + 1) << (octave - 2)) - 1;
+}
+
+static void record(Histogram* h, uint64_t ns) {
+    h->count++;
+    h->total_ns += ns;
+    if (ns > h->max_ns)
+        h->max_ns = ns;
+    h->buckets[bucket_of(ns)]++;
+}
+
+static uint64_t percentile_ns(const Histogram* h, double p) {
+    if (h->count == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(p * (h->count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return upper < h->max_ns ? upper : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+// The summary and the end of the timeline are also written from the signal
+// handler, so they are built without stdio: plain appends into a caller's
+// buffer, then write(2)
+static void put_text(char* out, int* used, const char* text) {
+    while (*text && *used < SUMMARY_SIZE - 1)
+        out[(*used)++] = *text++;
+}
+
+static void put_number(char* out, int* used, uint64_t value) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (count > 0 && *used < SUMMARY_SIZE - 1)
+        out[(*used)++] = digits[--count];
+}
+
+// Nanoseconds as microseconds with 'decimals' (1 or 2) digits, truncated
+static void put_us(char* out, int* used, uint64_t ns, int decimals) {
+    put_number(out, used, ns / 1000);
+    put_text(out, used, ".");
+    uint64_t fraction = ns % 1000 / (decimals == 1 ? 100 : 10);
+    if (decimals == 2 && fraction < 10)
+        put_text(out, used, "0");
+    put_number(out, used, fraction);
+}
+
+static void write_all(int fd, const char* data, int length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written <= 0)
+            return;
+        data += written;
+        length -= written;
+    }
+}
+
+static void dump() {
+    if (!path)
+        return;
+    char text[SUMMARY_SIZE];
+    int used = 0;
+    put_text(text, &used, "{\"steps\": ");
+    put_number(text, &used, steps);
+    put_text(text, &used, ", \"phases\": {");
+    for (int i = 0; i < PROFILE_PHASES; i++) {
+        const Histogram* h = &histograms[i];
+        put_text(text, &used, i ? ",\n  \"" : "\n  \"");
+        put_text(text, &used, phase_names[i]);
+        put_text(text, &used, "\": {\"count\": ");
+        put_number(text, &used, h->count);
+        put_text(text, &used, ", \"total_us\": ");
+        put_us(text, &used, h->total_ns, 1);
+        put_text(text, &used, ", \"p50_us\": ");
+        put_us(text, &used, percentile_ns(h, 0.50), 2);
+        put_text(text, &used, ", \"p99_us\": ");
+        put_us(text, &used, percentile_ns(h, 0.99), 2);
+        put_text(text, &used, ", \"max_us\": ");
+        put_us(text, &used, h->max_ns, 2);
+        put_text(text, &used, "}");
+    }
+    put_text(text, &used, "\n}}\n");
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return;
+    write_all(fd, text, used);
+    close(fd);
+}
+
+static void flush_timeline() {
+    timeline_flushing = 1;
+    write_all(timeline, timeline_buffer, timeline_used);
+    timeline_used = 0;
+    timeline_flushing = 0;
+}
+
+// The trace-event array may be left unterminated, so a killed solver still
+// leaves a loadable file; closing it properly just adds the bracket. A
+// signal in the middle of a flush loses the buffer rather than repeating it.
+static void close_timeline() {
+    if (timeline >= 0) {
+        if (!timeline_flushing)
+            write_all(timeline, timeline_buffer, timeline_used);
+        write_all(timeline, "\n]\n", 3);
+        close(timeline);
+        timeline = -1;
+    }
+}
+
+static void finish() {
+    dump();
+    close_timeline();
+}
+
+// finish() only computes and calls open/write/close, all safe in a handler.
+// The signal then goes on to whatever handled it before (log.c, or the default).
+static void on_signal(int sig) {
+    finish();
+    sigaction(sig, sig == SIGINT ? &previous_int : &previous_term, NULL);
+    raise(sig);
+}
+
+static void open_profile() {
+    state = 1;
+    path = getenv("MMS_PROFILE");
+    if (path && !*path)
+        path = NULL;
+
+    const char* timeline_path = getenv("MMS_TIMELINE");
+    if (timeline_path && *timeline_path) {
+        timeline = open(timeline_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (timeline >= 0) {
+            timeline_buffer[0] = '[';
+            timeline_used = 1;
+        } else {
+            fprintf(stderr, "profile: cannot write %s\n", timeline_path);
+        }
+    }
+    if (!path && timeline < 0)
+        return;
+
+    memset(histograms, 0, sizeof(histograms));
+    origin = clock_ns();
+    atexit(finish);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+    state = 2;
+}
+
+// Appends one event; timeline_used only moves past it once it is complete
+static void timeline_printf(const char* format, ...) {
+    if (timeline_used > TIMELINE_BUFFER_SIZE - TIMELINE_EVENT_MAX)
+        flush_timeline();
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(&timeline_buffer[timeline_used], TIMELINE_EVENT_MAX, format, args);
+    va_end(args);
+    if (length > 0 && length < TIMELINE_EVENT_MAX)
+        timeline_used += length;
+}
+
+static void timeline_event(const char* name, const char* category, uint64_t start,
+                           uint64_t end) {
+    timeline_printf("%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+                    "\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                    timeline_events++ ? "," : "", name, category, (start - origin) / 1e3,
+                    (end - start) / 1e3);
+}
+
+uint64_t profile_now() {
+    if (state == 0)
+        open_profile();
+    return state == 2 ? clock_ns() : 0;
+}
+
+void profile_io(ProfilePhase phase, const char* call, uint64_t start) {
+    if (state != 2)
+        return;
+    uint64_t end = clock_ns();
+    uint64_t span = end - start;
+    if (nested_ns > 0 && nested_start >= start) {
+        span = span > nested_ns ? span - nested_ns : 0;
+        nested_ns = 0;
+    }
+    step_io[phase] += span;
+    if (timeline >= 0)
+        timeline_event(call, phase_names[phase], start, end);
+}
+
+void profile_io_nested(ProfilePhase phase, const char* call, uint64_t start) {
+    if (state != 2)
+        return;
+    uint64_t end = clock_ns();
+    step_io[phase] += end - start;
+    if (nested_ns == 0)
+        nested_start = start;
+    nested_ns += end - start;
+    if (timeline >= 0)
+        timeline_event(call, phase_names[phase], start, end);
+}
+
+void profile_span(const char* name, uint64_t start) {
+    if (state != 2 || timeline < 0)
+        return;
+    timeline_event(name, "solver", start, clock_ns());
+}
+
+void profile_counter(const char* name, long value) {
+    if (state != 2 || timeline < 0)
+        return;
+    timeline_printf("%s\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,"
+                    "\"args\":{\"value\":%ld}}",
+                    timeline_events++ ? "," : "", name, (clock_ns() - origin) / 1e3, value);
+}
+
+void profile_step_begin() {
+    step_start = profile_now();
+    memset(step_io, 0, sizeof(step_io));
+}
+
+void profile_step_end() {
+    if (state != 2)
+        return;
+
+    uint64_t total = clock_ns() - step_start;
+    uint64_t io = 0;
+    for (int i = 0; i < PROFILE_IO_PHASES; i++) {
+        // Per-step time of each phase, only for steps that used it
+        if (step_io[i] > 0)
+            record(&histograms[i], step_io[i]);
+        io += step_io[i];
+    }
+    record(&histograms[PROFILE_COMPUTE], total > io ? total - io : 0);
+    record(&histograms[PROFILE_STEP], total);
+
+    if (++steps % PROFILE_DUMP_STEPS == 0)
+        dump();
+}
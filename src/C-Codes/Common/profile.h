@@ -0,0 +1,37 @@
+#pragma once
+
+// Per-step wall time split between solver compute and simulator I/O.
+// Set MMS_PROFILE=<file> to enable; a JSON summary with p50/p99 per phase is
+// written there at exit, on SIGINT/SIGTERM, and every PROFILE_DUMP_STEPS steps.
+//
+// Set MMS_TIMELINE=<file> to also write Chrome trace-event JSON (open it in
+// Perfetto or chrome://tracing): one span per API round trip and per solver
+// span reported below, plus counters.
+
+#include <stdint.h>
+
+typedef enum {
+    PROFILE_SENSE,    // wall sensors, wasReset, maze size
+    PROFILE_MOTION,   // moveForward, turns, ackReset
+    PROFILE_DISPLAY,  // setColor/setText/setWall and their clear calls
+    PROFILE_IO_PHASES
+} ProfilePhase;
+
+// Monotonic nanoseconds, 0 when profiling is off
+uint64_t profile_now();
+
+// Charge the time since 'start' (from profile_now) to an I/O phase;
+// 'call' names the span on the timeline
+void profile_io(ProfilePhase phase, const char* call, uint64_t start);
+
+// Same, for work done inside another I/O call (vis.c draining display commands
+// ahead of a query): the enclosing profile_io() leaves this time out
+void profile_io_nested(ProfilePhase phase, const char* call, uint64_t start);
+
+// Timeline-only: a solver span from 'start' to now, and a counter sample
+void profile_span(const char* name, uint64_t start);
+void profile_counter(const char* name, long value);
+
+// Bracket one iteration of the driver loop; compute = step - I/O inside it
+void profile_step_begin();
+void profile_step_end();
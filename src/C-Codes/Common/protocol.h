@@ -0,0 +1,52 @@
+#pragma once
+
+// Binary framed protocol between a solver and a simulator stand-in.
+//
+// A simulator that speaks it starts the solver with MMS_PROTOCOL=binary. The
+// real mms simulator never sets the variable, and the handshake below is
+// plain text lines, so a solver started with it by hand under mms still
+// works: it only offers binary when both maze sides fit in a byte, and an
+// ignored offer leaves it on text.
+//
+//   solver:    "mazeWidth\n" "mazeHeight\n"
+//   simulator: "<width>\n" "<height>\n"
+//   solver:    "binary <PROTO_VERSION>\n" "mazeWidth\n"
+//   simulator: "binary <PROTO_VERSION>\n" to accept (nothing, or any other
+//              line, to decline), then "<width>\n"
+// An accepting simulator switches to binary frames after that last reply.
+//
+// Requests are an opcode byte followed by packed arguments:
+//   queries, clear-all commands      op
+//   setWall/clearWall/setColor       op, x, y, char
+//   clearColor/clearText             op, x, y
+//   setText                          op, x, y, length, bytes (at most 32)
+// Coordinates are single bytes, so mazes are limited to 255x255. Every
+// query gets a one-byte reply: the maze size, 1/0 for true/false, or
+// 1 = ack and 0 = crash for moves.
+// Display commands get no reply.
+
+#define PROTO_VERSION 1
+#define PROTO_HELLO "binary"
+#define PROTO_TEXT_MAX 32
+
+// Opcodes (same numbering as the trace ops)
+typedef enum {
+    PROTO_MAZE_WIDTH = 1,
+    PROTO_MAZE_HEIGHT,
+    PROTO_WALL_FRONT,
+    PROTO_WALL_RIGHT,
+    PROTO_WALL_LEFT,
+    PROTO_MOVE_FORWARD,
+    PROTO_TURN_RIGHT,
+    PROTO_TURN_LEFT,
+    PROTO_SET_WALL,
+    PROTO_CLEAR_WALL,
+    PROTO_SET_COLOR,
+    PROTO_CLEAR_COLOR,
+    PROTO_CLEAR_ALL_COLOR,
+    PROTO_SET_TEXT,
+    PROTO_CLEAR_TEXT,
+    PROTO_CLEAR_ALL_TEXT,
+    PROTO_WAS_RESET,
+    PROTO_ACK_RESET
+} ProtoOp;
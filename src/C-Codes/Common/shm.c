@@ -0,0 +1,96 @@
+// shm.c - Shared-memory ring transport (see shm.h)
+#include "shm.h"
+#include <linux/futex.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static ShmChannel* channel = NULL;
+static int state = 0;  // 0 = not checked, 1 = off, 2 = mapped
+static int spin_limit = 0;
+static unsigned replies_taken = 0;
+
+static void futex_wait(atomic_uint* word, unsigned expected) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint* word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void wake_simulator() {
+    if (atomic_load(&channel->simulator_waiting)) {
+        atomic_store(&channel->simulator_waiting, 0);
+        futex_wake(&channel->request_head);
+    }
+}
+
+int shm_enabled() {
+    if (state == 0) {
+        state = 1;
+        const char* value = getenv("MMS_SHM");
+        if (value) {
+            void* map = mmap(NULL, sizeof(ShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED,
+                             atoi(value), 0);
+            if (map != MAP_FAILED && ((ShmChannel*)map)->magic == SHM_MAGIC) {
+                channel = map;
+                state = 2;
+                // Spinning only pays off while the simulator runs on another CPU
+                spin_limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHM_SPIN : 0;
+            }
+        }
+    }
+    return state == 2;
+}
+
+void shm_frame(const void* data, int length) {
+    unsigned head = atomic_load_explicit(&channel->request_head, memory_order_relaxed);
+
+    // Ring full: the simulator may be asleep with only display frames pending
+    while (head - atomic_load_explicit(&channel->request_tail, memory_order_acquire) >
+           SHM_RING_SIZE - (unsigned)length) {
+        wake_simulator();
+        sched_yield();
+    }
+
+    unsigned offset = head & (SHM_RING_SIZE - 1);
+    unsigned first = SHM_RING_SIZE - offset;
+    if (first >= (unsigned)length) {
+        memcpy(channel->ring + offset, data, length);
+    } else {
+        memcpy(channel->ring + offset, data, first);
+        memcpy(channel->ring, (const unsigned char*)data + first, length - first);
+    }
+    atomic_store(&channel->request_head, head + length);
+}
+
+void shm_send(const void* data, int length) {
+    shm_frame(data, length);
+    wake_simulator();
+}
+
+int shm_reply() {
+    unsigned seq = replies_taken++;
+
+    for (int spin = 0; spin < spin_limit; spin++) {
+        if (atomic_load_explicit(&channel->reply_seq, memory_order_acquire) != seq)
+            return channel->replies[seq % SHM_REPLY_RING];
+        cpu_relax();
+    }
+    while (atomic_load(&channel->reply_seq) == seq) {
+        atomic_store(&channel->solver_waiting, 1);
+        if (atomic_load(&channel->reply_seq) != seq)
+            break;
+        futex_wait(&channel->reply_seq, seq);
+    }
+    return channel->replies[seq % SHM_REPLY_RING];
+}
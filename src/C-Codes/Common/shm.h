@@ -0,0 +1,43 @@
+#pragma once
+
+// Shared-memory transport to a local simulator stand-in (Tools/headless -x).
+// The stand-in maps a ShmChannel, passes its descriptor in MMS_SHM=<fd> and
+// starts the solver; the solver then speaks the binary protocol of protocol.h
+// through the channel instead of stdin/stdout, without a hello.
+//
+// Requests (queries and display frames) are appended to a byte ring; the
+// simulator stores each one-byte reply in replies[reply_seq % SHM_REPLY_RING]
+// and then bumps reply_seq, so several requests may be in flight. Both sides
+// spin briefly, then sleep on a futex and set their *_waiting flag so the
+// other side only makes a wake syscall when someone is actually asleep.
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define SHM_MAGIC 0x524D4D53  // "SMMR"
+#define SHM_RING_SIZE 65536   // bytes, power of two
+#define SHM_REPLY_RING 64     // replies, power of two; more than the requests in flight
+#define SHM_SPIN 20000        // polls before sleeping on the futex (none on one CPU)
+
+typedef struct {
+    uint32_t magic;
+    // Solver -> simulator
+    _Alignas(64) atomic_uint request_head;  // bytes written (futex word)
+    atomic_uint simulator_waiting;
+    _Alignas(64) atomic_uint request_tail;  // bytes consumed
+    // Simulator -> solver
+    _Alignas(64) atomic_uint reply_seq;  // replies written (futex word)
+    atomic_uint solver_waiting;
+    unsigned char replies[SHM_REPLY_RING];
+    _Alignas(64) unsigned char ring[SHM_RING_SIZE];
+} ShmChannel;
+
+// 1 if MMS_SHM names a mapped channel
+int shm_enabled();
+
+// Append one display frame; returns without waiting for the simulator
+void shm_frame(const void* data, int length);
+
+// Append one request frame; shm_reply() waits for the oldest unanswered one
+void shm_send(const void* data, int length);
+int shm_reply();
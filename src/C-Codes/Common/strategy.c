@@ -0,0 +1,38 @@
+// strategy.c - name=value parameters for the selected strategy
+#include "strategy.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PARAMS 16
+
+static char* param_names[MAX_PARAMS];
+static char* param_values[MAX_PARAMS];
+static int param_count = 0;
+
+int strategy_set_params(int count, char* params[]) {
+    param_count = 0;
+    for (int i = 0; i < count; i++) {
+        char* equals = strchr(params[i], '=');
+        if (!equals || equals == params[i] || param_count == MAX_PARAMS)
+            return 0;
+        *equals = '\0';
+        param_names[param_count] = params[i];
+        param_values[param_count] = equals + 1;
+        param_count++;
+    }
+    return 1;
+}
+
+const char* strategy_param(const char* name, const char* fallback) {
+    // Later words override earlier ones
+    for (int i = param_count - 1; i >= 0; i--) {
+        if (strcmp(param_names[i], name) == 0)
+            return param_values[i];
+    }
+    return fallback;
+}
+
+int strategy_param_int(const char* name, int fallback) {
+    const char* value = strategy_param(name, NULL);
+    return value ? atoi(value) : fallback;
+}
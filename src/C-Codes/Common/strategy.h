@@ -0,0 +1,41 @@
+#pragma once
+
+// strategy.h - Common interface every solver registers behind
+//
+// main.c picks a strategy by name from the command line, calls init once
+// and then step once per driver step, applying the Action it returns.
+// Strategies with a reset hook get it called whenever the simulator reports
+// a reset; main.c acknowledges the reset afterwards. Strategies without one
+// are never asked, which saves a query per step.
+//
+// GIVE_UP means the strategy cannot get to the goal: no path left in what
+// it knows, a wall follower caught in a loop, or a maze too big for its
+// arrays. main.c then exits with EXIT_GAVE_UP instead of letting the
+// solver spin or wander forever.
+
+typedef enum Heading {NORTH, EAST, SOUTH, WEST} Heading;
+typedef enum Action {LEFT, FORWARD, RIGHT, IDLE, GIVE_UP} Action;
+
+#define EXIT_GAVE_UP 3
+
+typedef struct {
+    const char* name;         // command-line name
+    const char* description;  // one line for the usage message
+    void (*init)();
+    Action (*step)();
+    void (*reset)();          // mouse is back at (0,0) facing north; may be NULL
+    int (*stats)(char* buffer, int size);  // "key=value ..." summary; may be NULL
+} Strategy;
+
+// Registered in main.c
+extern const Strategy astar_strategy;
+extern const Strategy floodfill_strategy;
+extern const Strategy floodfill_astar_strategy;
+extern const Strategy left_hand_strategy;
+extern const Strategy right_hand_strategy;
+
+// Parameters are name=value words after the algorithm name; returns 0 if
+// one is malformed
+int strategy_set_params(int count, char* params[]);
+const char* strategy_param(const char* name, const char* fallback);
+int strategy_param_int(const char* name, int fallback);
@@ -0,0 +1,327 @@
+// trace.c - API call recorder with a background writer thread
+#include "trace.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_RING_SIZE 4096  // events, power of two
+#define TRACE_TEXT_SIZE 120
+#define TRACE_BUFFER_SIZE 8192
+
+// Raw event as captured on the solver thread; encoding happens on the writer
+struct TraceEvent {
+    uint8_t op;
+    uint8_t pending;  // trace_begin() without trace_end() yet
+    uint8_t length;
+    int16_t x, y;
+    char arg;
+    int result;
+    uint32_t start;
+    uint32_t duration;
+    char text[TRACE_TEXT_SIZE];
+};
+
+static int state = 0;  // 0 = not checked yet, 1 = off, 2 = recording
+static FILE* file = NULL;
+static TraceEvent* ring = NULL;
+static atomic_uint ring_head;  // end of the events the writer may drain
+static atomic_uint ring_tail;  // next slot the writer drains
+static atomic_int stopping;
+static atomic_int sleeping;    // writer is (about to be) waiting on 'wake'
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static unsigned reserved = 0;  // solver side: next slot claim() hands out
+static unsigned lost = 0;      // calls lost since the last gap record
+static unsigned lost_total = 0;
+
+// Writer-side encoder state
+static unsigned char buffer[TRACE_BUFFER_SIZE];
+static int buffer_used = 0;
+static uint32_t last_start = 0;
+static int last_x = 0;
+static int last_y = 0;
+
+static uint32_t clock_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+static void put_byte(unsigned char b) {
+    buffer[buffer_used++] = b;
+}
+
+static void put_varint(uint32_t value) {
+    while (value >= 0x80) {
+        put_byte((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte((unsigned char)value);
+}
+
+static void put_zigzag(int value) {
+    put_varint((uint32_t)((value << 1) ^ (value >> 31)));
+}
+
+static void encode(const TraceEvent* e) {
+    int is_query = e->op <= TRACE_TURN_LEFT || e->op == TRACE_WAS_RESET ||
+                   e->op == TRACE_ACK_RESET;
+    int is_bool = e->op >= TRACE_WALL_FRONT && e->op <= TRACE_MOVE_FORWARD;
+    if (e->op == TRACE_WAS_RESET)
+        is_bool = 1;
+
+    put_byte(e->op | (is_bool && e->result ? TRACE_RESULT_BIT : 0));
+    put_varint(e->start - last_start);
+    last_start = e->start;
+    if (is_query)
+        put_varint(e->duration);
+
+    switch (e->op) {
+        case TRACE_MAZE_WIDTH:
+        case TRACE_MAZE_HEIGHT:
+        case TRACE_GAP:
+            put_varint((uint32_t)e->result);
+            break;
+        case TRACE_SET_WALL:
+        case TRACE_CLEAR_WALL:
+        case TRACE_SET_COLOR:
+        case TRACE_CLEAR_COLOR:
+        case TRACE_SET_TEXT:
+        case TRACE_CLEAR_TEXT:
+            put_zigzag(e->x - last_x);
+            put_zigzag(e->y - last_y);
+            last_x = e->x;
+            last_y = e->y;
+            if (e->op == TRACE_SET_WALL || e->op == TRACE_CLEAR_WALL || e->op == TRACE_SET_COLOR)
+                put_byte((unsigned char)e->arg);
+            break;
+        default:
+            break;
+    }
+
+    if (e->op == TRACE_SET_TEXT || e->op == TRACE_DEBUG_LOG) {
+        put_varint(e->length);
+        memcpy(&buffer[buffer_used], e->text, e->length);
+        buffer_used += e->length;
+    }
+}
+
+static void flush_buffer() {
+    if (buffer_used > 0) {
+        fwrite(buffer, 1, buffer_used, file);
+        buffer_used = 0;
+    }
+    fflush(file);
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+
+    while (1) {
+        unsigned tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&ring_head, memory_order_acquire);
+
+        if (tail == head) {
+            flush_buffer();
+            if (atomic_load(&stopping))
+                break;
+            // Announce the sleep, then look again so an event published in
+            // between is not left waiting for the next one
+            pthread_mutex_lock(&lock);
+            atomic_store(&sleeping, 1);
+            if (atomic_load(&ring_head) == tail && !atomic_load(&stopping))
+                pthread_cond_wait(&wake, &lock);
+            atomic_store(&sleeping, 0);
+            pthread_mutex_unlock(&lock);
+            continue;
+        }
+
+        while (tail != head) {
+            if (buffer_used > TRACE_BUFFER_SIZE - 128)
+                flush_buffer();
+            encode(&ring[tail & (TRACE_RING_SIZE - 1)]);
+            tail++;
+        }
+        atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+static void wake_writer() {
+    if (atomic_load(&sleeping)) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+static void publish();
+
+static void trace_close() {
+    // Moves never acknowledged are written as failed rather than held back
+    for (unsigned i = atomic_load(&ring_head); i != reserved; i++)
+        ring[i & (TRACE_RING_SIZE - 1)].pending = 0;
+    publish();
+    atomic_store(&stopping, 1);
+    pthread_mutex_lock(&lock);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+    fclose(file);
+    if (lost_total > 0)
+        fprintf(stderr, "trace: lost %u calls behind an unacknowledged move, "
+                        "marked with gap records\n", lost_total);
+}
+
+static void trace_open() {
+    state = 1;
+    const char* path = getenv("MMS_TRACE");
+    if (!path || !*path)
+        return;
+
+    file = fopen(path, "wb");
+    ring = malloc(TRACE_RING_SIZE * sizeof(TraceEvent));
+    if (!file || !ring) {
+        fprintf(stderr, "trace: cannot record to %s\n", path);
+        if (file)
+            fclose(file);
+        return;
+    }
+
+    unsigned char header[5] = {'M', 'M', 'T', 'R', TRACE_VERSION};
+    fwrite(header, 1, sizeof(header), file);
+
+    // First record's delta is taken from the moment recording starts
+    last_start = clock_us();
+    atomic_init(&ring_head, 0);
+    atomic_init(&ring_tail, 0);
+    atomic_init(&stopping, 0);
+    atomic_init(&sleeping, 0);
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        fclose(file);
+        return;
+    }
+    atexit(trace_close);
+    state = 2;
+}
+
+// Next free slot, waiting for the writer while the ring is full
+static TraceEvent* reserve() {
+    while (1) {
+        unsigned tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+        if (reserved - tail < TRACE_RING_SIZE)
+            break;
+        // Drained up to a pending move: only its ack frees the ring
+        if (tail == atomic_load_explicit(&ring_head, memory_order_relaxed))
+            return NULL;
+        wake_writer();
+        sched_yield();
+    }
+    TraceEvent* e = &ring[reserved++ & (TRACE_RING_SIZE - 1)];
+    e->pending = 0;
+    return e;
+}
+
+static TraceEvent* claim() {
+    if (state == 0)
+        trace_open();
+    if (state != 2)
+        return NULL;
+
+    if (lost > 0) {
+        TraceEvent* gap = reserve();
+        if (!gap) {
+            lost++;
+            lost_total++;
+            return NULL;
+        }
+        gap->op = TRACE_GAP;
+        gap->result = lost;
+        gap->start = clock_us();
+        lost = 0;
+    }
+    TraceEvent* e = reserve();
+    if (!e) {
+        lost++;
+        lost_total++;
+    }
+    return e;
+}
+
+// Hands the writer every filled event up to the first one still pending
+static void publish() {
+    unsigned head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    while (head != reserved && !ring[head & (TRACE_RING_SIZE - 1)].pending)
+        head++;
+    atomic_store(&ring_head, head);
+    wake_writer();
+}
+
+uint32_t trace_now() {
+    if (state == 0)
+        trace_open();
+    return state == 2 ? clock_us() : 0;
+}
+
+void trace_query(TraceOp op, int result, uint32_t start) {
+    TraceEvent* e = claim();
+    if (!e)
+        return;
+    e->op = op;
+    e->result = result;
+    e->start = start;
+    e->duration = clock_us() - start;
+    publish();
+}
+
+TraceEvent* trace_begin(TraceOp op, uint32_t start) {
+    TraceEvent* e = claim();
+    if (!e)
+        return NULL;
+    e->op = op;
+    e->start = start;
+    e->pending = 1;
+    return e;
+}
+
+void trace_end(TraceEvent* event, int result) {
+    if (!event)
+        return;
+    event->result = result;
+    event->duration = clock_us() - event->start;
+    event->pending = 0;
+    publish();
+}
+
+void trace_command(TraceOp op, int x, int y, char arg) {
+    TraceEvent* e = claim();
+    if (!e)
+        return;
+    e->op = op;
+    e->x = x;
+    e->y = y;
+    e->arg = arg;
+    e->start = clock_us();
+    publish();
+}
+
+void trace_text(TraceOp op, int x, int y, const char* text) {
+    TraceEvent* e = claim();
+    if (!e)
+        return;
+    size_t length = strlen(text);
+    if (length > TRACE_TEXT_SIZE)
+        length = TRACE_TEXT_SIZE;
+    e->op = op;
+    e->x = x;
+    e->y = y;
+    e->length = (uint8_t)length;
+    memcpy(e->text, text, length);
+    e->start = clock_us();
+    publish();
+}
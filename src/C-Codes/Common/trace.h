@@ -0,0 +1,63 @@
+#pragma once
+
+// Binary trace of every call through API.h.
+// Set MMS_TRACE=<file> to record; without it every hook is a single branch.
+//
+// File: "MMTR" + version byte, then one record per call:
+//   op byte (bit 7 = boolean result for sensor/move/wasReset calls)
+//   varint  microseconds since the previous record started (or since recording began)
+//   varint  round-trip microseconds (calls that wait for a reply)
+//   payload by op: varint result (maze size), zigzag x/y deltas from the
+//   previous coordinates + one char (walls, colors), varint length + bytes (text,
+//   truncated to 120 bytes), varint count of calls lost (gap)
+// Records are in the order the calls started, so a pipelined moveForward
+// comes before the display commands sent while it was in flight. Nothing is
+// dropped: a full ring makes the solver wait for the writer. Only when it
+// fills up behind a move still waiting for its ack are calls lost, and a gap
+// record marks the spot.
+
+#include <stdint.h>
+
+#define TRACE_VERSION 2
+
+typedef enum {
+    TRACE_MAZE_WIDTH = 1,
+    TRACE_MAZE_HEIGHT,
+    TRACE_WALL_FRONT,
+    TRACE_WALL_RIGHT,
+    TRACE_WALL_LEFT,
+    TRACE_MOVE_FORWARD,
+    TRACE_TURN_RIGHT,
+    TRACE_TURN_LEFT,
+    TRACE_SET_WALL,
+    TRACE_CLEAR_WALL,
+    TRACE_SET_COLOR,
+    TRACE_CLEAR_COLOR,
+    TRACE_CLEAR_ALL_COLOR,
+    TRACE_SET_TEXT,
+    TRACE_CLEAR_TEXT,
+    TRACE_CLEAR_ALL_TEXT,
+    TRACE_WAS_RESET,
+    TRACE_ACK_RESET,
+    TRACE_DEBUG_LOG,
+    TRACE_GAP
+} TraceOp;
+
+#define TRACE_RESULT_BIT 0x80
+
+// Monotonic microseconds, 0 when tracing is off
+uint32_t trace_now();
+
+// Calls answered by the simulator; 'start' is trace_now() taken before the request
+void trace_query(TraceOp op, int result, uint32_t start);
+
+// A call answered later (pipelined moves): its record keeps its place from
+// trace_begin() and holds back everything after it until trace_end() gives the
+// result. NULL when tracing is off; trace_end() accepts that.
+typedef struct TraceEvent TraceEvent;
+TraceEvent* trace_begin(TraceOp op, uint32_t start);
+void trace_end(TraceEvent* event, int result);
+
+// Display commands (x, y may be unused)
+void trace_command(TraceOp op, int x, int y, char arg);
+void trace_text(TraceOp op, int x, int y, const char* text);
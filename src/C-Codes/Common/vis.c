@@ -0,0 +1,195 @@
+// vis.c - Ordered asynchronous writer for simulator commands
+#include "vis.h"
+#include "profile.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VIS_RING_SIZE 4096  // commands, power of two
+#define VIS_LINE_SIZE 63
+
+static int state = 0;  // 0 = not started, 1 = synchronous fallback, 2 = writer running
+// One queued command: a text line or a binary frame
+typedef struct {
+    unsigned char length;
+    char data[VIS_LINE_SIZE];
+} Slot;
+
+static Slot* ring = NULL;
+static atomic_uint ring_head;  // next slot the solver fills
+static atomic_uint ring_tail;  // next slot to drain
+static atomic_int stopping;
+static atomic_int sleeping;    // writer is (about to be) waiting on 'wake'
+static pthread_t writer;
+
+// Whoever holds drain_lock is the ring's single consumer: the writer thread,
+// or the solver itself when it sends a query
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+
+// Caller holds drain_lock; returns the number of commands written
+static int drain() {
+    unsigned tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring_head, memory_order_acquire);
+    if (tail == head)
+        return 0;
+    int count = head - tail;
+    while (tail != head) {
+        const Slot* slot = &ring[tail & (VIS_RING_SIZE - 1)];
+        fwrite(slot->data, 1, slot->length, stdout);
+        tail++;
+    }
+    atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    return count;
+}
+
+// Sleeps until a command is queued, then writes out everything queued by then
+static void* writer_main(void* arg) {
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&drain_lock);
+        if (drain() > 0)
+            fflush(stdout);
+        pthread_mutex_unlock(&drain_lock);
+
+        // Announce the sleep, then look again so a command queued in between
+        // is not left waiting for the next one
+        pthread_mutex_lock(&wake_lock);
+        atomic_store(&sleeping, 1);
+        int idle = atomic_load(&ring_head) == atomic_load(&ring_tail);
+        if (idle && !atomic_load(&stopping))
+            pthread_cond_wait(&wake, &wake_lock);
+        atomic_store(&sleeping, 0);
+        pthread_mutex_unlock(&wake_lock);
+
+        if (idle && atomic_load(&stopping))
+            break;
+    }
+    return NULL;
+}
+
+static void wake_writer() {
+    if (atomic_load(&sleeping)) {
+        pthread_mutex_lock(&wake_lock);
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&wake_lock);
+    }
+}
+
+static void vis_close() {
+    pthread_mutex_lock(&wake_lock);
+    atomic_store(&stopping, 1);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&wake_lock);
+    pthread_join(writer, NULL);
+}
+
+static void vis_start() {
+    state = 1;
+    ring = malloc(VIS_RING_SIZE * sizeof(Slot));
+    if (!ring)
+        return;
+
+    atomic_init(&ring_head, 0);
+    atomic_init(&ring_tail, 0);
+    atomic_init(&stopping, 0);
+    atomic_init(&sleeping, 0);
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0)
+        return;
+    atexit(vis_close);
+    state = 2;
+}
+
+// Next free slot, waiting for the writer if the ring is full
+static Slot* claim() {
+    unsigned head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&ring_tail, memory_order_acquire) >= VIS_RING_SIZE) {
+        wake_writer();
+        sched_yield();
+    }
+    return &ring[head & (VIS_RING_SIZE - 1)];
+}
+
+// Publishes the claimed slot; the store and the writer's check of 'sleeping'
+// are both sequentially consistent, so the writer cannot miss it
+static void publish() {
+    atomic_fetch_add(&ring_head, 1);
+    wake_writer();
+}
+
+void vis_command(const char* format, ...) {
+    if (state == 0)
+        vis_start();
+
+    va_list args;
+    va_start(args, format);
+    if (state != 2) {
+        vprintf(format, args);
+        putchar('\n');
+        fflush(stdout);
+        va_end(args);
+        return;
+    }
+
+    Slot* slot = claim();
+    int length = vsnprintf(slot->data, VIS_LINE_SIZE, format, args);
+    va_end(args);
+    if (length > VIS_LINE_SIZE - 1)
+        length = VIS_LINE_SIZE - 1;
+    slot->data[length] = '\n';
+    slot->length = length + 1;
+    publish();
+}
+
+void vis_frame(const void* data, int length) {
+    if (state == 0)
+        vis_start();
+    if (length > VIS_LINE_SIZE)
+        length = VIS_LINE_SIZE;
+    if (state != 2) {
+        fwrite(data, 1, length, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    Slot* slot = claim();
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    publish();
+}
+
+// Drain what is queued, then send the request in the same write. Waiting for
+// the writer and writing out the queue are display work, so that time goes to
+// the display phase rather than to the query that happened to carry it.
+static void send_request(const void* data, int length) {
+    if (state == 0)
+        vis_start();
+    if (state == 2) {
+        uint64_t start = profile_now();
+        int waited = pthread_mutex_trylock(&drain_lock) != 0;
+        if (waited)
+            pthread_mutex_lock(&drain_lock);
+        if (drain() > 0 || waited)
+            profile_io_nested(PROFILE_DISPLAY, "drain", start);
+    }
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+    if (state == 2)
+        pthread_mutex_unlock(&drain_lock);
+}
+
+void vis_query(const char* command) {
+    char line[VIS_LINE_SIZE + 1];
+    int length = snprintf(line, sizeof(line), "%s\n", command);
+    send_request(line, length < (int)sizeof(line) ? length : (int)sizeof(line) - 1);
+}
+
+void vis_query_frame(const void* data, int length) {
+    send_request(data, length);
+}
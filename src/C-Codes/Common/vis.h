@@ -0,0 +1,18 @@
+#pragma once
+
+// Output channel to the simulator.
+// Display commands (text lines or binary frames) are queued in a lock-free ring instead of being written
+// on the solver's path. The queue is drained, in order, into the next query
+// line so a whole step's display updates and the query go out in one write;
+// a background writer drains it when no query comes for a millisecond or the
+// ring fills up. The simulator always sees lines in the order they were issued.
+
+// Queue one display command (printf-style, newline added)
+void vis_command(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+// Queue one binary protocol frame (at most 63 bytes)
+void vis_frame(const void* data, int length);
+
+// Send a query line, or a binary request frame, after every command issued before it
+void vis_query(const char* command);
+void vis_query_frame(const void* data, int length);
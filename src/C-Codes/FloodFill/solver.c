@@ -1,12 +1,25 @@
 // floodfill.c - Classic Micromouse Flood Fill Algorithm
-#include "solver.h"
+#include "strategy.h"
 #include "API.h"
+#include "capture.h"
+#include "log.h"
+#include "maze.h"
+#include "profile.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifndef MAX_SIZE
 #define MAX_SIZE 16
+#endif
 #define INF 9999
-#define MAX_QUEUE 256
+#define MAX_QUEUE (MAX_SIZE * MAX_SIZE)
+
+// Saved maze file (walls, known edges and distances survive resets and restarts)
+#define MAZE_FILE "maze.bin"
+#define MAZE_FILE_VERSION 3
+#define MAZE_FILE_ALGORITHM 'F'  // walls are stored on both sides of each edge
 
 // Global state
 static int x = 0;
@@ -21,6 +34,26 @@ static int distance[MAX_SIZE][MAX_SIZE];
 // Wall map: walls[y][x][dir] - 1 if wall exists
 static char walls[MAX_SIZE][MAX_SIZE][4];
 
+// Known-edge map: known[y][x][dir] - 1 if the edge has been sensed
+static char known[MAX_SIZE][MAX_SIZE][4];
+
+// Edges known only from maze.bin, not sensed yet in this process. The file
+// may come from another maze, so each one is checked when its cell is
+// scanned and the first that disagrees drops them all (dropSavedMap).
+static char saved[MAX_SIZE][MAX_SIZE][4];
+static int savedMap = 0;  // saved edges still in use
+
+// Zobrist hash of the wall map: one random key per (cell, dir), XORed in by addWall
+static uint64_t zobrist[MAX_SIZE][MAX_SIZE][4];
+static uint64_t wallHash = 0;
+
+// Wall hash the distance field was last computed for; walls only ever get
+// added, so an older field never comes back and one slot is all it takes
+static int distanceValid = 0;
+static uint64_t distanceHash = 0;
+static int fieldCacheHits = 0;
+static int fieldCacheMisses = 0;
+
 // Goal cells
 static int goalX[4];
 static int goalY[4];
@@ -39,26 +72,89 @@ static QueueNode queue[MAX_QUEUE];
 static int queueHead = 0;
 static int queueTail = 0;
 
-void initMaze() {
-    static int initialized = 0;
-    if (initialized) return;
-    
+// Speculative decisions for the cell being entered, one per possible
+// front/right/left wall reading (bit 0 = front, 1 = right, 2 = left), worked
+// out while moveForward waits for its ack (speculate=1)
+typedef struct {
+    int valid;
+    uint64_t hash;      // wall hash once that reading is added
+    int reflooded;      // distance holds a new field
+    int bestDir;
+    int distance[MAX_SIZE][MAX_SIZE];
+} Speculation;
+
+static Speculation speculation[8];
+static int speculationX = -1;
+static int speculationY = -1;
+static int speculationDirection = -1;
+static char speculationWalls[MAX_SIZE][MAX_SIZE][4];
+static int speculationHits = 0;
+static int speculationMisses = 0;
+static int speculationEnabled = 0;  // speculate=1
+
+// Progress of the current run
+static int steps = 0;
+static int goalReached = 0;
+static int tooLarge = 0;
+
+// splitmix64 - fixed seed so hashes are identical across runs
+static uint64_t nextZobrist(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void initZobrist() {
+    uint64_t state = 0x4D4D4150;
+    for (int j = 0; j < MAX_SIZE; j++) {
+        for (int i = 0; i < MAX_SIZE; i++) {
+            for (int d = 0; d < 4; d++) {
+                zobrist[j][i][d] = nextZobrist(&state);
+            }
+        }
+    }
+}
+
+// Full recompute, only needed after walls are replaced wholesale (loadMaze)
+static void computeWallHash() {
+    wallHash = 0;
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            for (int d = 0; d < 4; d++) {
+                if (walls[j][i][d]) wallHash ^= zobrist[j][i][d];
+            }
+        }
+    }
+}
+
+static void initMaze() {
     mazeWidth = API_mazeWidth();
     mazeHeight = API_mazeHeight();
+    if (mazeWidth > MAX_SIZE || mazeHeight > MAX_SIZE) {
+        log_error("Maze %dx%d is larger than MAX_SIZE %d", mazeWidth, mazeHeight, MAX_SIZE);
+        tooLarge = 1;
+        return;
+    }
+    
+    initZobrist();
     
     // Initialize walls (optimistic - no walls initially)
     memset(walls, 0, sizeof(walls));
+    memset(known, 0, sizeof(known));
     
     // Add boundary walls
     for (int y = 0; y < mazeHeight; y++) {
-        walls[y][0][3] = 1;  // West wall
-        walls[y][mazeWidth - 1][1] = 1;  // East wall
+        walls[y][0][3] = known[y][0][3] = 1;  // West wall
+        walls[y][mazeWidth - 1][1] = known[y][mazeWidth - 1][1] = 1;  // East wall
     }
     for (int x = 0; x < mazeWidth; x++) {
-        walls[0][x][2] = 1;  // South wall
-        walls[mazeHeight - 1][x][0] = 1;  // North wall
+        walls[0][x][2] = known[0][x][2] = 1;  // South wall
+        walls[mazeHeight - 1][x][0] = known[mazeHeight - 1][x][0] = 1;  // North wall
     }
     
+    computeWallHash();
+    
     // Calculate goal cells (2x2 center)
     int centerX = mazeWidth / 2;
     int centerY = mazeHeight / 2;
@@ -67,22 +163,18 @@ void initMaze() {
     goalX[2] = centerX - 1; goalY[2] = centerY;
     goalX[3] = centerX;     goalY[3] = centerY;
     
-    char msg[64];
-    sprintf(msg, "Maze: %dx%d, Goals: (%d,%d) (%d,%d) (%d,%d) (%d,%d)", 
-            mazeWidth, mazeHeight,
-            goalX[0], goalY[0], goalX[1], goalY[1],
-            goalX[2], goalY[2], goalX[3], goalY[3]);
-    debug_log(msg);
+    log_info("Maze: %dx%d, Goals: (%d,%d) (%d,%d) (%d,%d) (%d,%d)", 
+             mazeWidth, mazeHeight,
+             goalX[0], goalY[0], goalX[1], goalY[1],
+             goalX[2], goalY[2], goalX[3], goalY[3]);
     
     // Mark goal cells in red
     for (int i = 0; i < 4; i++) {
         API_setColor(goalX[i], goalY[i], 'R');
     }
-    
-    initialized = 1;
 }
 
-int isGoal(int px, int py) {
+static int isGoal(int px, int py) {
     for (int i = 0; i < 4; i++) {
         if (px == goalX[i] && py == goalY[i]) {
             return 1;
@@ -91,35 +183,193 @@ int isGoal(int px, int py) {
     return 0;
 }
 
-void addWall(int px, int py, int dir) {
-    walls[py][px][dir] = 1;
+// Adds the wall and its mirror to a wall map; returns the change to its hash
+static uint64_t addWallTo(char map[MAX_SIZE][MAX_SIZE][4], int px, int py, int dir) {
+    uint64_t change = 0;
+    if (!map[py][px][dir]) {
+        map[py][px][dir] = 1;
+        change ^= zobrist[py][px][dir];
+    }
     
     // Add mirror wall
     int nx = px + dx[dir];
     int ny = py + dy[dir];
     if (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight) {
         int oppositeDir = (dir + 2) % 4;
-        walls[ny][nx][oppositeDir] = 1;
+        if (!map[ny][nx][oppositeDir]) {
+            map[ny][nx][oppositeDir] = 1;
+            change ^= zobrist[ny][nx][oppositeDir];
+        }
+    }
+    return change;
+}
+
+static void addWall(int px, int py, int dir) {
+    wallHash ^= addWallTo(walls, px, py, dir);
+}
+
+static void markKnown(int px, int py, int dir) {
+    known[py][px][dir] = 1;
+    saved[py][px][dir] = 0;
+    
+    int nx = px + dx[dir];
+    int ny = py + dy[dir];
+    if (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight) {
+        known[ny][nx][(dir + 2) % 4] = 1;
+        saved[ny][nx][(dir + 2) % 4] = 0;
+    }
+}
+
+static void floodFillDistances();
+
+// Forgets every edge that only maze.bin vouched for, keeping what this
+// process sensed; returns 0 if there was no saved map left to drop
+static int dropSavedMap(const char* reason) {
+    if (!savedMap)
+        return 0;
+    log_warn("Saved maze does not match (%s) - exploring from scratch", reason);
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            for (int d = 0; d < 4; d++) {
+                if (saved[j][i][d] || !known[j][i][d])
+                    walls[j][i][d] = known[j][i][d] = 0;
+            }
+        }
+    }
+    memset(saved, 0, sizeof(saved));
+    savedMap = 0;
+    speculationX = -1;
+    computeWallHash();
+    floodFillDistances();
+    return 1;
+}
+
+static void scanWalls() {
+    int sides[3] = {direction, (direction + 1) % 4, (direction + 3) % 4};
+    int reading[3] = {API_wallFront(), API_wallRight(), API_wallLeft()};
+    for (int i = 0; i < 3; i++) {
+        if (saved[y][x][sides[i]] && walls[y][x][sides[i]] != reading[i]) {
+            dropSavedMap("wall sensed differently");
+            break;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (reading[i])
+            addWall(x, y, sides[i]);
+        markKnown(x, y, sides[i]);
     }
 }
 
-void scanWalls() {
-    if (API_wallFront()) {
-        addWall(x, y, direction);
+// Save file layout (little endian):
+//   "MMAP", version, algorithm, width, height, reserved
+//   width*height bytes: low nibble = walls (bit d = dir d), high nibble = known edges
+//   width*height uint16: distance to goal (0xFFFF = unreachable)
+static void saveMaze() {
+    FILE* file = fopen(MAZE_FILE, "wb");
+    if (!file) {
+        log_warn("WARNING: could not save maze file");
+        return;
+    }
+    
+    unsigned char header[9] = {'M', 'M', 'A', 'P', MAZE_FILE_VERSION, MAZE_FILE_ALGORITHM,
+                               (unsigned char)mazeWidth, (unsigned char)mazeHeight, 0};
+    fwrite(header, 1, sizeof(header), file);
+    
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            unsigned char cell = 0;
+            for (int d = 0; d < 4; d++) {
+                if (walls[j][i][d]) cell |= 1 << d;
+                if (known[j][i][d]) cell |= 1 << (d + 4);
+            }
+            fputc(cell, file);
+        }
+    }
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            int dist = distance[j][i] < INF ? distance[j][i] : 0xFFFF;
+            fputc(dist & 0xFF, file);
+            fputc((dist >> 8) & 0xFF, file);
+        }
+    }
+    fclose(file);
+}
+
+// Returns 1 if a save written by this solver for a maze of this size was
+// loaded; otherwise the maze is left untouched. Nothing in the file proves it
+// is this maze, so its edges are only a prior until sensed (saved).
+static int loadMaze() {
+    FILE* file = fopen(MAZE_FILE, "rb");
+    if (!file) return 0;
+    
+    unsigned char header[9];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, "MMAP", 4) != 0 || header[4] != MAZE_FILE_VERSION ||
+        header[5] != MAZE_FILE_ALGORITHM || header[6] != mazeWidth ||
+        header[7] != mazeHeight) {
+        fclose(file);
+        return 0;
+    }
+    
+    int cells = mazeWidth * mazeHeight;
+    unsigned char data[MAX_SIZE * MAX_SIZE * 3];
+    if (fread(data, 1, cells * 3, file) != (size_t)(cells * 3)) {
+        fclose(file);
+        return 0;
     }
-    if (API_wallRight()) {
-        addWall(x, y, (direction + 1) % 4);
+    fclose(file);
+    
+    // The whole file is read and checked; only now replace the maze
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            unsigned char cell = data[j * mazeWidth + i];
+            for (int d = 0; d < 4; d++) {
+                // Boundary edges are known already; the rest are the file's word
+                saved[j][i][d] = !known[j][i][d] && ((cell >> (d + 4)) & 1);
+                walls[j][i][d] = (cell >> d) & 1;
+                known[j][i][d] = (cell >> (d + 4)) & 1;
+            }
+            unsigned char* raw = &data[cells + 2 * (j * mazeWidth + i)];
+            int dist = raw[0] | (raw[1] << 8);
+            distance[j][i] = dist == 0xFFFF ? INF : dist;
+        }
     }
-    if (API_wallLeft()) {
-        addWall(x, y, (direction + 3) % 4);
+    computeWallHash();
+    distanceValid = 0;  // saved field may predate the last walls saved
+    savedMap = 1;
+    return 1;
+}
+
+// Display distances
+static void showDistances() {
+    static int shownAt = -1;
+    if (!API_displayDue(&shownAt))
+        return;
+    
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            if (distance[j][i] < INF) {
+                char text[12];  // any int
+                snprintf(text, sizeof(text), "%d", distance[j][i]);
+                API_setText(i, j, text);
+            }
+        }
     }
 }
 
-void floodFillDistances() {
+// The distance field now in place matches the current walls
+static void storeDistances() {
+    distanceValid = 1;
+    distanceHash = wallHash;
+}
+
+// BFS from all goal cells over the given wall map
+static void floodFillField(char map[MAX_SIZE][MAX_SIZE][4], int field[MAX_SIZE][MAX_SIZE],
+                    int* queuePeak) {
     // Initialize all distances
     for (int i = 0; i < mazeHeight; i++) {
         for (int j = 0; j < mazeWidth; j++) {
-            distance[i][j] = INF;
+            field[i][j] = INF;
         }
     }
     
@@ -128,7 +378,7 @@ void floodFillDistances() {
     queueTail = 0;
     
     for (int i = 0; i < 4; i++) {
-        distance[goalY[i]][goalX[i]] = 0;
+        field[goalY[i]][goalX[i]] = 0;
         queue[queueTail].x = goalX[i];
         queue[queueTail].y = goalY[i];
         queueTail++;
@@ -136,15 +386,17 @@ void floodFillDistances() {
     
     // BFS
     while (queueHead < queueTail) {
+        if (queueTail - queueHead > *queuePeak)
+            *queuePeak = queueTail - queueHead;
         int cx = queue[queueHead].x;
         int cy = queue[queueHead].y;
         queueHead++;
         
-        int currentDist = distance[cy][cx];
+        int currentDist = field[cy][cx];
         
         // Check all 4 neighbors
         for (int d = 0; d < 4; d++) {
-            if (walls[cy][cx][d]) continue;
+            if (map[cy][cx][d]) continue;
             
             int nx = cx + dx[d];
             int ny = cy + dy[d];
@@ -152,80 +404,183 @@ void floodFillDistances() {
             if (nx < 0 || nx >= mazeWidth || ny < 0 || ny >= mazeHeight) continue;
             
             int newDist = currentDist + 1;
-            if (newDist < distance[ny][nx]) {
-                distance[ny][nx] = newDist;
+            if (newDist < field[ny][nx]) {
+                field[ny][nx] = newDist;
                 queue[queueTail].x = nx;
                 queue[queueTail].y = ny;
                 queueTail++;
             }
         }
     }
-    
-    // Display distances
-    for (int j = 0; j < mazeHeight; j++) {
-        for (int i = 0; i < mazeWidth; i++) {
-            if (distance[j][i] < INF) {
-                char text[8];
-                sprintf(text, "%d", distance[j][i]);
-                API_setText(i, j, text);
-            }
-        }
+}
+
+static void floodFillDistances() {
+    uint64_t spanStart = profile_now();
+    if (distanceValid && distanceHash == wallHash) {
+        fieldCacheHits++;
+        profile_span("floodFillDistances (cached)", spanStart);
+        showDistances();
+        return;
     }
+    fieldCacheMisses++;
+    
+    int queuePeak = 0;
+    floodFillField(walls, distance, &queuePeak);
+    
+    storeDistances();
+    profile_span("floodFillDistances", spanStart);
+    profile_counter("reflood cells", queueTail);
+    profile_counter("reflood queue peak", queuePeak);
+    showDistances();
 }
 
-int getBestDirection() {
+// Smallest distance among the open neighbors of (px, py), INF if none
+static int minNeighborDistance(char map[MAX_SIZE][MAX_SIZE][4], int field[MAX_SIZE][MAX_SIZE],
+                        int px, int py, int* bestDir) {
     int minDist = INF;
-    int bestDir = -1;
+    *bestDir = -1;
     
     for (int d = 0; d < 4; d++) {
-        if (walls[y][x][d]) continue;
+        if (map[py][px][d]) continue;
         
-        int nx = x + dx[d];
-        int ny = y + dy[d];
+        int nx = px + dx[d];
+        int ny = py + dy[d];
         
         if (nx < 0 || nx >= mazeWidth || ny < 0 || ny >= mazeHeight) continue;
         
-        if (distance[ny][nx] < minDist) {
-            minDist = distance[ny][nx];
-            bestDir = d;
+        if (field[ny][nx] < minDist) {
+            minDist = field[ny][nx];
+            *bestDir = d;
         }
     }
     
+    return minDist;
+}
+
+// A cell whose distance is not one more than its best open neighbor's
+// means the field is stale (inconsistency detection)
+static int needsReflood(char map[MAX_SIZE][MAX_SIZE][4], int field[MAX_SIZE][MAX_SIZE], int px,
+                 int py) {
+    int bestDir;
+    int minNeighborDist = minNeighborDistance(map, field, px, py, &bestDir);
+    return minNeighborDist != INF && field[py][px] != minNeighborDist + 1;
+}
+
+static int getBestDirection() {
+    int bestDir;
+    minNeighborDistance(walls, distance, x, y, &bestDir);
     return bestDir;
 }
 
-void turnTo(int targetDir) {
-    while (direction != targetDir) {
-        int diff = (targetDir - direction + 4) % 4;
-        if (diff == 1) {
-            API_turnRight();
-            direction = (direction + 1) % 4;
-        } else if (diff == 3) {
-            API_turnLeft();
-            direction = (direction + 3) % 4;
-        } else {
-            API_turnRight();
-            API_turnRight();
-            direction = (direction + 2) % 4;
+// Work out the next decision at (px, py) for every wall reading the sensors
+// can still give there; readings that contradict known edges are skipped
+static void speculateAt(int px, int py, int dir) {
+    int sides[3] = {dir, (dir + 1) % 4, (dir + 3) % 4};
+    speculationX = px;
+    speculationY = py;
+    speculationDirection = dir;
+    
+    for (int reading = 0; reading < 8; reading++) {
+        Speculation* guess = &speculation[reading];
+        guess->valid = 0;
+        
+        int possible = 1;
+        for (int i = 0; i < 3; i++) {
+            int wall = (reading >> i) & 1;
+            if (known[py][px][sides[i]] && walls[py][px][sides[i]] != wall)
+                possible = 0;
         }
+        if (!possible)
+            continue;
+        
+        memcpy(speculationWalls, walls, sizeof(walls));
+        uint64_t hash = wallHash;
+        for (int i = 0; i < 3; i++) {
+            if ((reading >> i) & 1)
+                hash ^= addWallTo(speculationWalls, px, py, sides[i]);
+        }
+        
+        memcpy(guess->distance, distance, sizeof(distance));
+        guess->reflooded = needsReflood(speculationWalls, guess->distance, px, py);
+        if (guess->reflooded) {
+            int queuePeak = 0;
+            floodFillField(speculationWalls, guess->distance, &queuePeak);
+        }
+        minNeighborDistance(speculationWalls, guess->distance, px, py, &guess->bestDir);
+        guess->hash = hash;
+        guess->valid = 1;
     }
 }
 
-Action solver() {
-    return floodFill();
+// The speculative decision matching the walls just scanned, if any
+static Speculation* takeSpeculation() {
+    if (speculationX != x || speculationY != y || speculationDirection != direction)
+        return NULL;
+    speculationX = -1;
+    
+    for (int reading = 0; reading < 8; reading++) {
+        if (speculation[reading].valid && speculation[reading].hash == wallHash)
+            return &speculation[reading];
+    }
+    return NULL;
 }
 
-Action floodFill() {
-    static int initialized = 0;
-    static int steps = 0;
-    static int goalReached = 0;
+// Snapshot pose, distances and sensed walls for MMS_CAPTURE
+static void captureState() {
+    static int calls = 0;
+    calls++;
+    CaptureCell* cells = capture_cells(mazeWidth, mazeHeight);
+    if (!cells)
+        return;
     
-    if (!initialized) {
-        initMaze();
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            int wallBits = 0;
+            int knownBits = 0;
+            for (int d = 0; d < 4; d++) {
+                wallBits |= walls[j][i][d] << d;
+                knownBits |= known[j][i][d] << d;
+            }
+            capture_set(&cells[j * mazeWidth + i], distance[j][i] < INF ? distance[j][i] : -1,
+                        wallBits, knownBits);
+        }
+    }
+    capture_frame(calls, x, y, direction);
+}
+
+static void floodFillInit() {
+    initMaze();
+    if (tooLarge)
+        return;
+    speculationEnabled = strategy_param_int("speculate", 0) > 0;
+    if (loadMaze()) {
+        log_info("Loaded saved maze - warm start");
+        showDistances();
+    } else {
         floodFillDistances();  // Initial optimistic flood fill
-        debug_log("Starting Flood Fill Algorithm");
-        initialized = 1;
     }
+    log_info("Starting Flood Fill Algorithm");
+}
+
+// Simulator reset: mouse is back at the start, keep everything learned
+static void floodFillReset() {
+    saveMaze();
+    x = 0;
+    y = 0;
+    direction = 0;
+    steps = 0;
+    goalReached = 0;
+    API_clearAllColor();
+    for (int i = 0; i < 4; i++) {
+        API_setColor(goalX[i], goalY[i], 'R');
+    }
+    log_info("Reset - running again with the saved maze");
+}
+
+static Action floodFillStep() {
+    if (tooLarge)
+        return GIVE_UP;
+    captureState();
     
     if (goalReached) {
         return IDLE;
@@ -234,10 +589,12 @@ Action floodFill() {
     // Check if goal reached
     if (isGoal(x, y)) {
         API_setColor(x, y, 'G');
-        char msg[64];
-        sprintf(msg, "GOAL REACHED in %d steps!", steps);
-        debug_log(msg);
+        log_info("GOAL REACHED in %d steps!", steps);
+        log_info("Reflood cache: %d hits, %d misses", fieldCacheHits, fieldCacheMisses);
+        if (speculationEnabled)
+            log_info("Speculation: %d hits, %d misses", speculationHits, speculationMisses);
         goalReached = 1;
+        saveMaze();
         return IDLE;
     }
     
@@ -247,46 +604,60 @@ Action floodFill() {
     // Scan walls
     scanWalls();
     
-    // Check if reflood is needed (inconsistency detection)
-    int currentDist = distance[y][x];
-    int minNeighborDist = INF;
-    
-    for (int d = 0; d < 4; d++) {
-        if (walls[y][x][d]) continue;
-        
-        int nx = x + dx[d];
-        int ny = y + dy[d];
+    int bestDir;
+    Speculation* guess = takeSpeculation();
+    if (guess) {
+        // Worked out during the last move
+        speculationHits++;
+        if (guess->reflooded) {
+            memcpy(distance, guess->distance, sizeof(distance));
+            storeDistances();
+            showDistances();
+        }
+        bestDir = guess->bestDir;
+    } else {
+        if (speculationEnabled)
+            speculationMisses++;
         
-        if (nx >= 0 && nx < mazeWidth && ny >= 0 && ny < mazeHeight) {
-            if (distance[ny][nx] < minNeighborDist) {
-                minNeighborDist = distance[ny][nx];
-            }
+        // If inconsistent, reflood
+        if (needsReflood(walls, distance, x, y)) {
+            log_debug("Inconsistency detected - reflooding");
+            floodFillDistances();
         }
+        
+        // Get best direction
+        bestDir = getBestDirection();
     }
     
-    // If inconsistent, reflood
-    if (minNeighborDist != INF && currentDist != minNeighborDist + 1) {
-        debug_log("Inconsistency detected - reflooding");
-        floodFillDistances();
+    if (bestDir == -1) {
+        // Confirm on a fresh field: unknown walls count as open, so no
+        // path here means none exists - unless the walls came from maze.bin
+        if (!dropSavedMap("no path left"))
+            floodFillDistances();
+        bestDir = getBestDirection();
     }
-    
-    // Get best direction
-    int bestDir = getBestDirection();
-    
     if (bestDir == -1) {
-        debug_log("ERROR: No path available!");
-        return IDLE;
+        log_error("ERROR: No path available!");
+        return GIVE_UP;
     }
     
     // Log move
-    char msg[80];
-    sprintf(msg, "Step %d: (%d,%d) dist=%d -> %c", 
-            steps, x, y, distance[y][x], "NESW"[bestDir]);
-    debug_log(msg);
-    
-    // Execute move
-    turnTo(bestDir);
-    if (API_moveForward()) {
+    log_debug("Step %d: (%d,%d) dist=%d -> %c", 
+              steps, x, y, distance[y][x], "NESW"[bestDir]);
+    
+    // Execute move, planning the next cell while the simulator moves the mouse
+    maze_turn_to(&direction, bestDir);
+    int moved;
+    int nextX = x + dx[direction];
+    int nextY = y + dy[direction];
+    if (speculationEnabled && !isGoal(nextX, nextY)) {
+        API_moveForwardStart();
+        speculateAt(nextX, nextY, direction);
+        moved = API_moveForwardFinish();
+    } else {
+        moved = API_moveForward();
+    }
+    if (moved) {
         steps++;
         x += dx[direction];
         y += dy[direction];
@@ -295,10 +666,18 @@ Action floodFill() {
     return IDLE;
 }
 
-Action leftWallFollower() {
-    return IDLE;
+static int floodFillStats(char* buffer, int size) {
+    return snprintf(buffer, size, "steps=%d goal=%d reflood_hits=%d reflood_misses=%d "
+                    "speculation_hits=%d speculation_misses=%d",
+                    steps, goalReached, fieldCacheHits, fieldCacheMisses,
+                    speculationHits, speculationMisses);
 }
 
-Action rightWallFollower() {
-    return IDLE;
-}
\ No newline at end of file
+const Strategy floodfill_strategy = {
+    "floodfill",
+    "flood fill towards the centre (speculate=1 plans during moves)",
+    floodFillInit,
+    floodFillStep,
+    floodFillReset,
+    floodFillStats,
+};
@@ -0,0 +1,245 @@
+// corridor.c - Junction/corridor graph over the known maze
+#include "corridor.h"
+#include <string.h>
+
+#define MAX_CELLS (MAX_SIZE * MAX_SIZE)
+
+// Direction vectors: 0=N, 1=E, 2=S, 3=W
+static const int dx[] = {0, 1, 0, -1};
+static const int dy[] = {1, 0, -1, 0};
+
+// Corridor between two nodes, stored at both ends
+typedef struct {
+    int valid;
+    int id;          // bumped on every re-walk, owners with a stale id are ignored
+    Position to;
+    int length;
+} Edge;
+
+// Which edge a corridor cell lies on and how far it is from the edge's start node
+typedef struct {
+    int id;
+    Position node;
+    int dir;
+    int offset;
+} Owner;
+
+static int width = 0;
+static int height = 0;
+
+static unsigned char open_mask[MAX_SIZE][MAX_SIZE];  // bit d = no wall in direction d
+static unsigned char pinned[MAX_SIZE][MAX_SIZE];
+static unsigned char is_node[MAX_SIZE][MAX_SIZE];
+static unsigned char pruned[MAX_SIZE][MAX_SIZE];
+static Edge edges[MAX_SIZE][MAX_SIZE][4];
+static Owner owner[MAX_SIZE][MAX_SIZE];
+static int next_edge_id = 0;
+
+// Cells whose corridors must be re-walked before the next pruning query
+static unsigned char dirty[MAX_SIZE][MAX_SIZE];
+static Position dirty_list[MAX_CELLS];
+static int dirty_count = 0;
+
+static CorridorStats stats;
+
+static int opening_count(int mask) {
+    return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+static void update_node(int x, int y) {
+    is_node[x][y] = pinned[x][y] || opening_count(open_mask[x][y]) != 2;
+}
+
+static void mark_dirty(Position p) {
+    if (!dirty[p.x][p.y]) {
+        dirty[p.x][p.y] = 1;
+        dirty_list[dirty_count++] = p;
+    }
+}
+
+// Queue re-walks for every corridor that runs through or ends at (x, y)
+static void touch(int x, int y) {
+    mark_dirty((Position){x, y});
+
+    if (is_node[x][y]) {
+        for (int d = 0; d < 4; d++) {
+            if (edges[x][y][d].valid)
+                mark_dirty(edges[x][y][d].to);
+        }
+        return;
+    }
+
+    Owner* o = &owner[x][y];
+    Edge* e = &edges[o->node.x][o->node.y][o->dir];
+    if (e->valid && e->id == o->id) {
+        mark_dirty(o->node);
+        mark_dirty(e->to);
+    }
+}
+
+// Re-walk the corridor leaving node n in direction d, claiming its cells
+static void walk_edge(Position n, int d) {
+    Edge* e = &edges[n.x][n.y][d];
+    e->id = ++next_edge_id;
+
+    Position cur = {n.x + dx[d], n.y + dy[d]};
+    int back = (d + 2) % 4;
+    int length = 1;
+
+    while (!is_node[cur.x][cur.y] && length <= MAX_CELLS) {
+        owner[cur.x][cur.y] = (Owner){e->id, n, d, length};
+        int mask = open_mask[cur.x][cur.y] & ~(1 << back);
+        int nd = 0;
+        while (!(mask & (1 << nd)))
+            nd++;
+        cur.x += dx[nd];
+        cur.y += dy[nd];
+        back = (nd + 2) % 4;
+        length++;
+    }
+
+    e->valid = 1;
+    e->to = cur;
+    e->length = length;
+    stats.rebuilds++;
+}
+
+// Nodes left with a single live corridor can never be on a path between pinned cells
+static void prune_dead_ends() {
+    static int degree[MAX_SIZE][MAX_SIZE];
+    static Position leaves[MAX_CELLS];
+    int leaf_count = 0;
+
+    memset(pruned, 0, sizeof(pruned));
+    stats.nodes = 0;
+    stats.edges = 0;
+
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            if (!is_node[x][y])
+                continue;
+            stats.nodes++;
+            degree[x][y] = opening_count(open_mask[x][y]);
+            stats.edges += degree[x][y];
+            if (degree[x][y] <= 1 && !pinned[x][y]) {
+                pruned[x][y] = 1;
+                leaves[leaf_count++] = (Position){x, y};
+            }
+        }
+    }
+    stats.edges /= 2;
+
+    for (int i = 0; i < leaf_count; i++) {
+        Position leaf = leaves[i];
+        for (int d = 0; d < 4; d++) {
+            Edge* e = &edges[leaf.x][leaf.y][d];
+            if (!e->valid || pruned[e->to.x][e->to.y])
+                continue;
+
+            Position t = e->to;
+            if (--degree[t.x][t.y] <= 1 && !pinned[t.x][t.y]) {
+                pruned[t.x][t.y] = 1;
+                leaves[leaf_count++] = t;
+            }
+        }
+    }
+    stats.pruned = leaf_count;
+}
+
+static void rebuild() {
+    if (dirty_count == 0)
+        return;
+
+    for (int i = 0; i < dirty_count; i++) {
+        Position p = dirty_list[i];
+        for (int d = 0; d < 4; d++)
+            edges[p.x][p.y][d].valid = 0;
+    }
+
+    for (int i = 0; i < dirty_count; i++) {
+        Position p = dirty_list[i];
+        dirty[p.x][p.y] = 0;
+        if (!is_node[p.x][p.y])
+            continue;
+        for (int d = 0; d < 4; d++) {
+            if (open_mask[p.x][p.y] & (1 << d))
+                walk_edge(p, d);
+        }
+    }
+    dirty_count = 0;
+
+    prune_dead_ends();
+}
+
+void corridor_init(int maze_width, int maze_height) {
+    width = maze_width;
+    height = maze_height;
+
+    memset(pinned, 0, sizeof(pinned));
+    memset(edges, 0, sizeof(edges));
+    memset(owner, 0, sizeof(owner));
+    memset(dirty, 0, sizeof(dirty));
+    memset(&stats, 0, sizeof(stats));
+    dirty_count = 0;
+    next_edge_id = 0;
+
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            int mask = 0;
+            for (int d = 0; d < 4; d++) {
+                int nx = x + dx[d];
+                int ny = y + dy[d];
+                if (nx >= 0 && nx < width && ny >= 0 && ny < height)
+                    mask |= 1 << d;
+            }
+            open_mask[x][y] = mask;
+            update_node(x, y);
+            mark_dirty((Position){x, y});
+        }
+    }
+}
+
+void corridor_add_wall(int x, int y, int dir) {
+    if (!(open_mask[x][y] & (1 << dir)))
+        return;
+
+    int nx = x + dx[dir];
+    int ny = y + dy[dir];
+
+    touch(x, y);
+    touch(nx, ny);
+
+    open_mask[x][y] &= ~(1 << dir);
+    open_mask[nx][ny] &= ~(1 << ((dir + 2) % 4));
+    update_node(x, y);
+    update_node(nx, ny);
+}
+
+void corridor_pin(int x, int y) {
+    if (pinned[x][y])
+        return;
+    touch(x, y);
+    pinned[x][y] = 1;
+    update_node(x, y);
+}
+
+int corridor_open_mask(int x, int y) {
+    return open_mask[x][y];
+}
+
+int corridor_is_pruned(int x, int y) {
+    rebuild();
+    if (is_node[x][y])
+        return pruned[x][y];
+
+    Owner* o = &owner[x][y];
+    Edge* e = &edges[o->node.x][o->node.y][o->dir];
+    if (!e->valid || e->id != o->id)
+        return 0;
+    return pruned[o->node.x][o->node.y] || pruned[e->to.x][e->to.y];
+}
+
+CorridorStats corridor_stats() {
+    rebuild();
+    return stats;
+}
@@ -0,0 +1,41 @@
+#ifndef CORRIDOR_H
+#define CORRIDOR_H
+
+// corridor.h - Junction/corridor graph of the known maze
+//
+// Junctions (3-4 openings), dead ends (0-1 openings) and pinned cells
+// (start, goals) are nodes; runs of two-opening corridor cells between
+// them collapse into one weighted edge. Walls are added incrementally and
+// only the corridors touching the changed cells are re-walked. The graph
+// finds dead-end branches for exploration to skip; the distance fields are
+// plain grid searches over corridor_open_mask (fields.h), which measured
+// faster than searching the graph at every size bench covers.
+
+#ifndef MAX_SIZE
+#define MAX_SIZE 16
+#endif
+
+typedef struct {
+    int x, y;
+} Position;
+
+typedef struct {
+    int nodes;
+    int pruned;             // dead-end nodes no start/goal path can use
+    int edges;
+    long rebuilds;          // corridors re-walked after wall changes
+} CorridorStats;
+
+void corridor_init(int width, int height);
+void corridor_add_wall(int x, int y, int dir);
+void corridor_pin(int x, int y);
+
+// Bit d set if there is no known wall in direction d
+int corridor_open_mask(int x, int y);
+
+// 1 if the cell sits in a dead-end branch that no start/goal path can use
+int corridor_is_pruned(int x, int y);
+
+CorridorStats corridor_stats();
+
+#endif
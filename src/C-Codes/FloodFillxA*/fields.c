@@ -0,0 +1,166 @@
+// fields.c - Dual distance field manager
+#include "fields.h"
+#include <string.h>
+
+// Direction vectors: 0=N, 1=E, 2=S, 3=W
+static const int dx[] = {0, 1, 0, -1};
+static const int dy[] = {1, 0, -1, 0};
+
+static int width = 0;
+static int height = 0;
+static Position goal_cells[4];
+static int goal_count = 0;
+static Position start_cell;
+static int inf_value = 0;
+
+// Wall state each field was built for
+static int goal_valid = 0;
+static int start_valid = 0;
+static uint64_t goal_built_for = 0;
+static uint64_t start_built_for = 0;
+static int rebuilds = 0;
+static int cells = 0;  // cells reached by the latest update
+
+static int to_goal[MAX_SIZE][MAX_SIZE];
+static int to_start[MAX_SIZE][MAX_SIZE];
+
+void fields_init(int maze_width, int maze_height, const Position* goals, int count,
+                 Position start, int inf) {
+    width = maze_width;
+    height = maze_height;
+    goal_count = count < 4 ? count : 4;
+    memcpy(goal_cells, goals, goal_count * sizeof(Position));
+    start_cell = start;
+    inf_value = inf;
+    goal_valid = 0;
+    start_valid = 0;
+}
+
+// Open neighbour with the lowest value in a field, -1 if none is closer
+static int downhill(int field[MAX_SIZE][MAX_SIZE], int x, int y) {
+    int mask = corridor_open_mask(x, y);
+    int best_dir = -1;
+    int best = field[x][y];
+
+    for (int d = 0; d < 4; d++) {
+        if (!(mask & (1 << d)))
+            continue;
+        int value = field[x + dx[d]][y + dy[d]];
+        if (value < best) {
+            best = value;
+            best_dir = d;
+        }
+    }
+    return best_dir;
+}
+
+// Breadth-first search over the known openings from the source cells
+static void build(int field[MAX_SIZE][MAX_SIZE], const Position* sources, int count) {
+    static Position queue[MAX_SIZE * MAX_SIZE];
+    int head = 0;
+    int tail = 0;
+
+    for (int x = 0; x < width; x++)
+        for (int y = 0; y < height; y++)
+            field[x][y] = inf_value;
+    for (int i = 0; i < count; i++) {
+        if (field[sources[i].x][sources[i].y] != 0) {
+            field[sources[i].x][sources[i].y] = 0;
+            queue[tail++] = sources[i];
+        }
+    }
+
+    while (head < tail) {
+        Position p = queue[head++];
+        int mask = corridor_open_mask(p.x, p.y);
+        int next = field[p.x][p.y] + 1;
+        for (int d = 0; d < 4; d++) {
+            if (!(mask & (1 << d)))
+                continue;
+            int nx = p.x + dx[d];
+            int ny = p.y + dy[d];
+            if (field[nx][ny] == inf_value) {
+                field[nx][ny] = next;
+                queue[tail++] = (Position){nx, ny};
+            }
+        }
+    }
+    cells += tail;
+}
+
+static int update_goal(uint64_t wall_hash) {
+    if (goal_valid && goal_built_for == wall_hash)
+        return 0;
+    build(to_goal, goal_cells, goal_count);
+    goal_valid = 1;
+    goal_built_for = wall_hash;
+    return 1;
+}
+
+static int update_start(uint64_t wall_hash) {
+    if (start_valid && start_built_for == wall_hash)
+        return 0;
+    build(to_start, &start_cell, 1);
+    start_valid = 1;
+    start_built_for = wall_hash;
+    return 1;
+}
+
+int fields_update(uint64_t wall_hash) {
+    cells = 0;
+    int rebuilt = update_goal(wall_hash) | update_start(wall_hash);
+    rebuilds += rebuilt;
+    return rebuilt;
+}
+
+int fields_update_goal(uint64_t wall_hash) {
+    cells = 0;
+    int rebuilt = update_goal(wall_hash);
+    rebuilds += rebuilt;
+    return rebuilt;
+}
+
+int fields_update_start(uint64_t wall_hash) {
+    cells = 0;
+    int rebuilt = update_start(wall_hash);
+    rebuilds += rebuilt;
+    return rebuilt;
+}
+
+int fields_to_goal(int x, int y) {
+    return to_goal[x][y];
+}
+
+int fields_to_start(int x, int y) {
+    return to_start[x][y];
+}
+
+// Worked out per call: routes ask for a handful of cells, not the whole maze
+int fields_goal_dir(int x, int y) {
+    return downhill(to_goal, x, y);
+}
+
+int fields_start_dir(int x, int y) {
+    return downhill(to_start, x, y);
+}
+
+int fields_shortest_length() {
+    return to_goal[start_cell.x][start_cell.y];
+}
+
+int fields_on_shortest_path(int x, int y) {
+    int length = fields_shortest_length();
+    return length < inf_value && to_goal[x][y] + to_start[x][y] == length;
+}
+
+void fields_copy_to_goal(int dist[MAX_SIZE][MAX_SIZE]) {
+    memcpy(dist, to_goal, sizeof(to_goal));
+}
+
+int fields_rebuilds() {
+    return rebuilds;
+}
+
+int fields_cells() {
+    return cells;
+}
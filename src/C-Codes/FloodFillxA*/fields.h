@@ -0,0 +1,39 @@
+#ifndef FIELDS_H
+#define FIELDS_H
+
+// fields.h - Goal-rooted and start-rooted distance fields kept in step
+//
+// Each field is a breadth-first search over the known openings, rebuilt
+// when the wall hash it was built for goes stale. Next-move and
+// on-shortest-path queries are then table lookups.
+
+#include <stdint.h>
+#include "corridor.h"
+
+void fields_init(int width, int height, const Position* goals, int goal_count,
+                 Position start, int inf);
+
+// Rebuild both fields if the walls changed since the last update; 1 if rebuilt
+int fields_update(uint64_t wall_hash);
+// The same for one field alone, for callers that walk only that one
+int fields_update_goal(uint64_t wall_hash);
+int fields_update_start(uint64_t wall_hash);
+
+int fields_to_goal(int x, int y);
+int fields_to_start(int x, int y);
+
+// Direction (0=N, 1=E, 2=S, 3=W) one step closer, or -1 at the root / if unreachable
+int fields_goal_dir(int x, int y);
+int fields_start_dir(int x, int y);
+
+// 1 if the cell lies on some shortest start-to-goal path
+int fields_on_shortest_path(int x, int y);
+int fields_shortest_length();
+
+void fields_copy_to_goal(int dist[MAX_SIZE][MAX_SIZE]);
+
+int fields_rebuilds();
+// Cells the latest update reached, over the fields it rebuilt
+int fields_cells();
+
+#endif
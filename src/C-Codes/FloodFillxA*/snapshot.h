@@ -0,0 +1,72 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// snapshot.h - Checkpoint and branch the solver mid-run
+//
+// A SolverSnapshot is one flat block with no pointers: copy it with memcpy
+// or plain assignment and restore it as often as needed. It holds what the
+// next decision depends on: pose, sensed walls, visited cells, distances,
+// phase, DFS stack and planned routes. The corridor graph and the distance
+// fields are rebuilt from the wall list on restore.
+
+#include <stdint.h>
+#include "corridor.h"
+
+#define MAX_STACK (MAX_SIZE * MAX_SIZE)
+#define MAX_WALLS (MAX_SIZE * MAX_SIZE * 4)
+
+// Wall structure
+typedef struct {
+    int x, y, dir;
+} Wall;
+
+// Planned route that stays valid until a sensed wall cuts one of its edges.
+// next_dir gives the move to make from any cell on the route in O(1).
+typedef struct {
+    int valid;
+    int length;
+    int index;
+    Position cells[MAX_STACK];
+    signed char next_dir[MAX_SIZE][MAX_SIZE];  // -1 = cell not on the route
+} PlannedPath;
+
+typedef struct {
+    int mouse_x, mouse_y, mouse_dir;
+    int maze_width, maze_height;
+    int phase;
+    int exploration_done;
+    int map_complete;
+    int optimal_run_started;
+    int stack_top;
+    int wall_count;
+    uint64_t wall_hash;
+    Position goal_cells[4];
+    Position dfs_stack[MAX_STACK];
+    Wall walls[MAX_WALLS];
+    unsigned char known_edges[MAX_SIZE][MAX_SIZE];
+    int saved_map;
+    unsigned char saved_edges[MAX_SIZE][MAX_SIZE];
+    int visited[MAX_SIZE][MAX_SIZE];
+    int distances[MAX_SIZE][MAX_SIZE];
+    PlannedPath return_path;
+    PlannedPath run_path;
+} SolverSnapshot;
+
+// Exploration orders a branch can continue with
+typedef enum {
+    EXPLORE_SHORTEST_FIRST,  // neighbors on a shortest start-goal path first (default)
+    EXPLORE_STRAIGHT_FIRST,  // as above, ties broken towards the current heading
+    EXPLORE_FIXED_ORDER,     // plain DFS in N, E, S, W order
+    EXPLORE_STRATEGIES
+} ExploreStrategy;
+
+extern const char* explore_strategy_names[EXPLORE_STRATEGIES];
+
+void solver_snapshot(SolverSnapshot* snapshot);
+void solver_restore(const SolverSnapshot* snapshot);
+void solver_set_strategy(ExploreStrategy strategy);
+
+// 1 once the optimal run has finished (or no route exists)
+int solver_done();
+
+#endif
@@ -1,37 +1,32 @@
 // solver.c - Complete Maze Solver with DFS + A* + Optimal Path
-#include "solver.h"
+#include "strategy.h"
 #include "API.h"
+#include "capture.h"
+#include "corridor.h"
+#include "fields.h"
+#include "log.h"
+#include "maze.h"
+#include "profile.h"
+#include "snapshot.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef MAX_SIZE
 #define MAX_SIZE 16
+#endif
 #define INF 9999
-#define MAX_STACK 256
-#define MAX_QUEUE 512
-#define MAX_HEAP 512
-#define MAX_WALLS 1024
+
+// Saved maze file (walls, known edges and distances survive resets and restarts)
+#define MAZE_FILE "maze.bin"
+#define MAZE_FILE_VERSION 3
+#define MAZE_FILE_ALGORITHM 'X'  // walls are stored one-sided, as add_wall keeps them
 
 // Direction vectors: 0=N, 1=E, 2=S, 3=W
 static const int dx[] = {0, 1, 0, -1};
 static const int dy[] = {1, 0, -1, 0};
 
-// Wall structure
-typedef struct {
-    int x, y, dir;
-} Wall;
-
-// Position structure
-typedef struct {
-    int x, y;
-} Position;
-
-// A* node
-typedef struct {
-    int f_score;
-    Position pos;
-} AStarNode;
-
 // Global state
 static int mouse_x = 0;
 static int mouse_y = 0;
@@ -42,6 +37,21 @@ static int maze_height = 0;
 // Wall tracking
 static Wall walls[MAX_WALLS];
 static int wall_count = 0;
+static unsigned char wall_bits[MAX_SIZE][MAX_SIZE];  // bit d = (x, y, d) is in walls
+
+// Zobrist hash of the wall list: one random key per (cell, dir), XORed in by add_wall
+static uint64_t zobrist[MAX_SIZE][MAX_SIZE][4];
+static uint64_t wall_hash = 0;
+
+// Known edges: bit d set once the wall/opening in direction d has been sensed
+static unsigned char known_edges[MAX_SIZE][MAX_SIZE];
+
+// Edges maze.bin knows but this process has not sensed yet. The file may come
+// from another maze, so its walls are only a prior: each cell is sensed the
+// first time the mouse stands on it, and the first reading that disagrees
+// drops the saved map (drop_saved_map).
+static unsigned char saved_edges[MAX_SIZE][MAX_SIZE];
+static int saved_map = 0;  // walls from maze.bin still in use
 
 // Visited cells for DFS
 static int visited[MAX_SIZE][MAX_SIZE];
@@ -56,29 +66,45 @@ static Position goal_cells[4];
 static Position dfs_stack[MAX_STACK];
 static int stack_top = -1;
 
-// BFS queue
-static Position bfs_queue[MAX_QUEUE];
-static int queue_head = 0;
-static int queue_tail = 0;
-
-// A* heap
-static AStarNode heap[MAX_HEAP];
-static int heap_size = 0;
-
 // Phase control
 static int phase = 0;  // 0=explore, 1=return, 2=optimal, 3=done
+static const char* phase_names[] = {"explore", "return", "optimal run", "done"};
+static uint64_t phase_start = 0;  // profile_now() when the current phase began
 static int exploration_done = 0;
-static Position path_to_start[MAX_STACK];
-static int path_index = 0;
-static int path_length = 0;
+static int map_complete = 0;  // goal found and a path back to start known; saved with the map
+static int too_large = 0;
 static int optimal_run_started = 0;
 
-// Helper functions
-int manhattan_distance(int x1, int y1, int x2, int y2) {
-    return abs(x1 - x2) + abs(y1 - y2);
+// Planned routes
+static PlannedPath return_path;  // phase 1: back to (0,0)
+static PlannedPath run_path;     // phase 2: start to goal
+static int route_lookups = 0;
+static int route_plans = 0;
+static int route_invalidations = 0;
+
+// Exploration order (see snapshot.h)
+static ExploreStrategy explore_strategy = EXPLORE_SHORTEST_FIRST;
+const char* explore_strategy_names[EXPLORE_STRATEGIES] = {"shortest-first", "straight-first",
+                                                          "fixed-order"};
+
+// splitmix64 - fixed seed so hashes are identical across runs
+static uint64_t next_zobrist(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void init_zobrist() {
+    uint64_t state = 0x4D4D4150;
+    for (int x = 0; x < MAX_SIZE; x++)
+        for (int y = 0; y < MAX_SIZE; y++)
+            for (int d = 0; d < 4; d++)
+                zobrist[x][y][d] = next_zobrist(&state);
 }
 
-int is_goal(int x, int y) {
+// Helper functions
+static int is_goal(int x, int y) {
     for (int i = 0; i < 4; i++) {
         if (goal_cells[i].x == x && goal_cells[i].y == y)
             return 1;
@@ -86,30 +112,92 @@ int is_goal(int x, int y) {
     return 0;
 }
 
-int has_wall(int x, int y, int dir) {
-    for (int i = 0; i < wall_count; i++) {
-        if (walls[i].x == x && walls[i].y == y && walls[i].dir == dir)
-            return 1;
+static int has_wall(int x, int y, int dir) {
+    return (wall_bits[x][y] >> dir) & 1;
+}
+
+// Planned path operations
+static void path_clear(PlannedPath* path) {
+    path->valid = 0;
+    path->length = 0;
+    path->index = 0;
+    memset(path->next_dir, -1, sizeof(path->next_dir));
+}
+
+// Index the route in path->cells so next_dir can be looked up per cell
+static void path_commit(PlannedPath* path, Position from) {
+    memset(path->next_dir, -1, sizeof(path->next_dir));
+    Position prev = from;
+    for (int i = 0; i < path->length; i++) {
+        Position next = path->cells[i];
+        for (int d = 0; d < 4; d++) {
+            if (prev.x + dx[d] == next.x && prev.y + dy[d] == next.y) {
+                path->next_dir[prev.x][prev.y] = d;
+                break;
+            }
+        }
+        prev = next;
     }
-    return 0;
+    path->index = 0;
+    path->valid = 1;
+    route_plans++;
 }
 
-void add_wall(int x, int y, int dir) {
+// Next move from the mouse cell, or -1 if the route must be replanned
+static int path_next_dir(PlannedPath* path) {
+    if (!path->valid)
+        return -1;
+    route_lookups++;
+    return path->next_dir[mouse_x][mouse_y];
+}
+
+// Drop the route only if the new wall blocks an edge it uses
+static void path_check_wall(PlannedPath* path, int x, int y, int dir) {
+    if (!path->valid)
+        return;
+    
+    int nx = x + dx[dir];
+    int ny = y + dy[dir];
+    int crosses = path->next_dir[x][y] == dir;
+    if (nx >= 0 && nx < maze_width && ny >= 0 && ny < maze_height)
+        crosses = crosses || path->next_dir[nx][ny] == (dir + 2) % 4;
+    
+    if (crosses) {
+        path->valid = 0;
+        route_invalidations++;
+    }
+}
+
+static void add_wall(int x, int y, int dir) {
     if (!has_wall(x, y, dir) && wall_count < MAX_WALLS) {
         walls[wall_count].x = x;
         walls[wall_count].y = y;
         walls[wall_count].dir = dir;
         wall_count++;
+        wall_bits[x][y] |= 1 << dir;
+        wall_hash ^= zobrist[x][y][dir];
+        corridor_add_wall(x, y, dir);
+        path_check_wall(&return_path, x, y, dir);
+        path_check_wall(&run_path, x, y, dir);
     }
 }
 
-void sense_walls() {
-    if (API_wallFront())
-        add_wall(mouse_x, mouse_y, mouse_dir);
-    if (API_wallLeft())
-        add_wall(mouse_x, mouse_y, (mouse_dir + 3) % 4);
-    if (API_wallRight())
-        add_wall(mouse_x, mouse_y, (mouse_dir + 1) % 4);
+static int drop_saved_map(const char* reason);
+
+static void sense_walls() {
+    int sides[3] = {mouse_dir, (mouse_dir + 3) % 4, (mouse_dir + 1) % 4};
+    int reading[3] = {API_wallFront(), API_wallLeft(), API_wallRight()};
+    for (int i = 0; i < 3; i++) {
+        if ((saved_edges[mouse_x][mouse_y] >> sides[i] & 1) &&
+            has_wall(mouse_x, mouse_y, sides[i]) != reading[i]) {
+            drop_saved_map("wall sensed differently");
+            break;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (reading[i])
+            add_wall(mouse_x, mouse_y, sides[i]);
+    }
     
     // Check back wall (opposite direction)
     int back_dir = (mouse_dir + 2) % 4;
@@ -117,293 +205,543 @@ void sense_walls() {
     int back_y = mouse_y + dy[back_dir];
     if (back_x < 0 || back_x >= maze_width || back_y < 0 || back_y >= maze_height)
         add_wall(mouse_x, mouse_y, back_dir);
+    
+    // All four sides are known: three sensed, the back one we came through
+    known_edges[mouse_x][mouse_y] = 0x0F;
+    saved_edges[mouse_x][mouse_y] = 0;
 }
 
-void turn_to_direction(int target_dir) {
-    while (mouse_dir != target_dir) {
-        int diff = (target_dir - mouse_dir + 4) % 4;
-        if (diff == 1) {
-            API_turnRight();
-            mouse_dir = (mouse_dir + 1) % 4;
-        } else if (diff == 3) {
-            API_turnLeft();
-            mouse_dir = (mouse_dir + 3) % 4;
-        } else {
-            API_turnRight();
-            API_turnRight();
-            mouse_dir = (mouse_dir + 2) % 4;
-        }
-    }
+// Outside exploration, only spend sensor round trips on cells not yet mapped
+static void sense_if_unknown() {
+    if (known_edges[mouse_x][mouse_y] != 0x0F)
+        sense_walls();
 }
 
 // Stack operations
-void stack_push(Position p) {
+static void stack_push(Position p) {
     if (stack_top < MAX_STACK - 1)
         dfs_stack[++stack_top] = p;
 }
 
-Position stack_pop() {
+static Position stack_pop() {
     return dfs_stack[stack_top--];
 }
 
-Position stack_peek() {
+static Position stack_peek() {
     return dfs_stack[stack_top];
 }
 
-int stack_size() {
+static int stack_size() {
     return stack_top + 1;
 }
 
-// Queue operations
-void queue_push(Position p) {
-    if (queue_tail < MAX_QUEUE)
-        bfs_queue[queue_tail++] = p;
+// Fixed-order DFS has no preference; the other strategies favor shortest-path cells
+static int preferred_neighbor(int x, int y) {
+    return explore_strategy == EXPLORE_FIXED_ORDER || fields_on_shortest_path(x, y);
 }
 
-Position queue_pop() {
-    return bfs_queue[queue_head++];
+// Get unvisited neighbors worth exploring, cells on a shortest start-goal path first.
+// Cells in dead-end branches cannot shorten the run and are left unexplored.
+static int get_unvisited_neighbors(Position* neighbors) {
+    int count = 0;
+    fields_update(wall_hash);
+    
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 4; i++) {
+            // Straight-first tries the current heading, then right, back, left
+            int d = explore_strategy == EXPLORE_STRAIGHT_FIRST ? (mouse_dir + i) % 4 : i;
+            int nx = mouse_x + dx[d];
+            int ny = mouse_y + dy[d];
+            if (nx >= 0 && nx < maze_width && ny >= 0 && ny < maze_height &&
+                !visited[nx][ny] && !has_wall(mouse_x, mouse_y, d) &&
+                !corridor_is_pruned(nx, ny) &&
+                preferred_neighbor(nx, ny) == (pass == 0)) {
+                neighbors[count].x = nx;
+                neighbors[count].y = ny;
+                count++;
+            }
+        }
+    }
+    return count;
 }
 
-int queue_empty() {
-    return queue_head >= queue_tail;
+// Exploration can stop once every cell on a shortest start-goal path has been
+// visited: unknown walls can only make other routes longer.
+static int shortest_path_explored() {
+    fields_update(wall_hash);
+    if (fields_shortest_length() >= INF)
+        return 0;
+    
+    for (int x = 0; x < maze_width; x++) {
+        for (int y = 0; y < maze_height; y++) {
+            if (fields_on_shortest_path(x, y) && !visited[x][y])
+                return 0;
+        }
+    }
+    return 1;
 }
 
-// Heap operations
-void heap_swap(int i, int j) {
-    AStarNode temp = heap[i];
-    heap[i] = heap[j];
-    heap[j] = temp;
+// Close the current phase's timeline span and open the next one
+static void set_phase(int next) {
+    if (next != phase) {
+        profile_span(phase_names[phase], phase_start);
+        phase_start = profile_now();
+    }
+    phase = next;
 }
 
-void heap_push(AStarNode node) {
-    if (heap_size >= MAX_HEAP) return;
-    
-    int i = heap_size++;
-    heap[i] = node;
-    
-    while (i > 0) {
-        int parent = (i - 1) / 2;
-        if (heap[parent].f_score <= heap[i].f_score) break;
-        heap_swap(parent, i);
-        i = parent;
-    }
+// Fresh corridor graph; start and goal cells stay graph nodes whatever their
+// walls look like
+static void init_corridor() {
+    corridor_init(maze_width, maze_height);
+    corridor_pin(0, 0);
+    for (int i = 0; i < 4; i++)
+        corridor_pin(goal_cells[i].x, goal_cells[i].y);
 }
 
-AStarNode heap_pop() {
-    AStarNode result = heap[0];
-    heap[0] = heap[--heap_size];
-    
-    int i = 0;
-    while (1) {
-        int left = 2 * i + 1;
-        int right = 2 * i + 2;
-        int smallest = i;
-        
-        if (left < heap_size && heap[left].f_score < heap[smallest].f_score)
-            smallest = left;
-        if (right < heap_size && heap[right].f_score < heap[smallest].f_score)
-            smallest = right;
-        
-        if (smallest == i) break;
-        
-        heap_swap(i, smallest);
-        i = smallest;
-    }
-    
-    return result;
+// Forgets the saved map together with everything built on it and explores
+// again from the mouse cell; returns 0 if there was no saved map to drop
+static int drop_saved_map(const char* reason) {
+    if (!saved_map)
+        return 0;
+    log_warn("Saved maze does not match (%s) - exploring from scratch", reason);
+    saved_map = 0;
+    memset(saved_edges, 0, sizeof(saved_edges));
+    memset(known_edges, 0, sizeof(known_edges));
+    wall_count = 0;
+    wall_hash = 0;
+    memset(wall_bits, 0, sizeof(wall_bits));
+    init_corridor();
+    path_clear(&return_path);
+    path_clear(&run_path);
+    for (int x = 0; x < MAX_SIZE; x++)
+        for (int y = 0; y < MAX_SIZE; y++)
+            distances[x][y] = INF;
+    exploration_done = 0;
+    map_complete = 0;
+    optimal_run_started = 0;
+    memset(visited, 0, sizeof(visited));
+    stack_top = -1;
+    stack_push((Position){mouse_x, mouse_y});
+    API_clearAllColor();
+    set_phase(0);
+    return 1;
 }
 
-// Get unvisited neighbors
-int get_unvisited_neighbors(Position* neighbors) {
-    int count = 0;
-    for (int d = 0; d < 4; d++) {
-        int nx = mouse_x + dx[d];
-        int ny = mouse_y + dy[d];
-        if (nx >= 0 && nx < maze_width && ny >= 0 && ny < maze_height &&
-            !visited[nx][ny] && !has_wall(mouse_x, mouse_y, d)) {
-            neighbors[count].x = nx;
-            neighbors[count].y = ny;
-            count++;
+static void log_plan_stats() {
+    log_info("Routes: %d lookups, %d plans, %d invalidated by walls",
+             route_lookups, route_plans, route_invalidations);
+    log_info("Distance fields: %d rebuilds, shortest path %d",
+             fields_rebuilds(), fields_shortest_length());
+    CorridorStats stats = corridor_stats();
+    log_info("Corridor graph: %d nodes (%d pruned), %d edges for %d cells",
+             stats.nodes, stats.pruned, stats.edges, maze_width * maze_height);
+}
+
+// Label every cell with its distance; the API only sends labels that changed
+static void show_distances() {
+    static int shown_at = -1;
+    if (!API_displayDue(&shown_at))
+        return;
+    
+    for (int y = 0; y < maze_height; y++) {
+        for (int x = 0; x < maze_width; x++) {
+            if (distances[x][y] < INF) {
+                char text[12];  // any int
+                snprintf(text, sizeof(text), "%d", distances[x][y]);
+                API_setText(x, y, text);
+            } else {
+                API_clearText(x, y);
+            }
         }
     }
-    return count;
 }
 
 // Calculate distances using BFS
-void calculate_distances() {
-    debug_log("Calculating distances from goal...");
+static void calculate_distances() {
+    log_debug("Calculating distances from goal...");
+    uint64_t span_start = profile_now();
     
-    // Initialize distances
-    for (int i = 0; i < MAX_SIZE; i++)
-        for (int j = 0; j < MAX_SIZE; j++)
-            distances[i][j] = INF;
+    // The goal field is rebuilt only when the walls changed since it was
+    // last built
+    int rebuilt = fields_update_goal(wall_hash);
+    fields_copy_to_goal(distances);
+    if (rebuilt) {
+        profile_span("calculate_distances", span_start);
+        profile_counter("field cells", fields_cells());
+    } else {
+        profile_span("calculate_distances (cached)", span_start);
+    }
+    show_distances();
+}
+
+// A* pathfinding to start
+static int find_path_to_start() {
+    log_debug("Finding path to start...");
+    uint64_t span_start = profile_now();
     
-    // Reset queue
-    queue_head = 0;
-    queue_tail = 0;
+    // Walk down the start-rooted field; the goal field is left for later
+    fields_update_start(wall_hash);
+    if (fields_to_start(mouse_x, mouse_y) < INF) {
+        Position current = {mouse_x, mouse_y};
+        int length = 0;
+        while ((current.x != 0 || current.y != 0) && length < MAX_STACK) {
+            int d = fields_start_dir(current.x, current.y);
+            current.x += dx[d];
+            current.y += dy[d];
+            return_path.cells[length++] = current;
+        }
+        
+        return_path.length = length;
+        path_commit(&return_path, (Position){mouse_x, mouse_y});
+        profile_span("find_path_to_start", span_start);
+        profile_counter("path cells", length);
+        log_debug("Path to start: %d steps", length);
+        return 1;
+    }
     
-    // Add all goal cells
-    for (int i = 0; i < 4; i++) {
-        distances[goal_cells[i].x][goal_cells[i].y] = 0;
-        queue_push(goal_cells[i]);
+    profile_span("find_path_to_start", span_start);
+    log_error("ERROR: No path to start!");
+    return 0;
+}
+
+// Save file layout (little endian):
+//   "MMAP", version, algorithm, width, height, flags (bit 0 = map complete)
+//   width*height bytes: low nibble = walls (bit d = dir d), high nibble = known edges
+//   width*height uint16: distance to goal (0xFFFF = unreachable)
+static void save_maze() {
+    FILE* file = fopen(MAZE_FILE, "wb");
+    if (!file) {
+        log_warn("WARNING: could not save maze file");
+        return;
     }
     
-    // BFS
-    while (!queue_empty()) {
-        Position current = queue_pop();
-        int current_dist = distances[current.x][current.y];
-        
-        for (int d = 0; d < 4; d++) {
-            if (has_wall(current.x, current.y, d))
-                continue;
-            
-            int nx = current.x + dx[d];
-            int ny = current.y + dy[d];
-            
-            if (nx < 0 || nx >= maze_width || ny < 0 || ny >= maze_height)
-                continue;
-            
-            if (distances[nx][ny] > current_dist + 1) {
-                distances[nx][ny] = current_dist + 1;
-                queue_push((Position){nx, ny});
+    unsigned char header[9] = {'M', 'M', 'A', 'P', MAZE_FILE_VERSION, MAZE_FILE_ALGORITHM,
+                               (unsigned char)maze_width, (unsigned char)maze_height,
+                               (unsigned char)map_complete};
+    fwrite(header, 1, sizeof(header), file);
+    
+    for (int y = 0; y < maze_height; y++) {
+        for (int x = 0; x < maze_width; x++) {
+            unsigned char cell = (known_edges[x][y] | saved_edges[x][y]) << 4;
+            for (int d = 0; d < 4; d++) {
+                if (has_wall(x, y, d))
+                    cell |= 1 << d;
             }
+            fputc(cell, file);
         }
     }
-    
-    // Display distances
     for (int y = 0; y < maze_height; y++) {
         for (int x = 0; x < maze_width; x++) {
-            if (distances[x][y] < INF) {
-                char text[10];
-                sprintf(text, "%d", distances[x][y]);
-                API_setText(x, y, text);
-            }
+            int dist = distances[x][y] < INF ? distances[x][y] : 0xFFFF;
+            fputc(dist & 0xFF, file);
+            fputc((dist >> 8) & 0xFF, file);
         }
     }
+    fclose(file);
 }
 
-// A* pathfinding to start
-int find_path_to_start() {
-    debug_log("Finding path to start with A*...");
-    
-    // Initialize
-    Position came_from[MAX_SIZE][MAX_SIZE];
-    int g_score[MAX_SIZE][MAX_SIZE];
-    int in_came_from[MAX_SIZE][MAX_SIZE];
-    
-    for (int i = 0; i < MAX_SIZE; i++) {
-        for (int j = 0; j < MAX_SIZE; j++) {
-            g_score[i][j] = INF;
-            in_came_from[i][j] = 0;
-        }
+// Reads a save written by this solver for a maze of this size. Returns -1
+// and leaves the solver untouched if there is none; otherwise installs the
+// map as a prior (saved_edges) and returns the saved flags.
+static int load_maze() {
+    FILE* file = fopen(MAZE_FILE, "rb");
+    if (!file) return -1;
+    
+    unsigned char header[9];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, "MMAP", 4) != 0 || header[4] != MAZE_FILE_VERSION ||
+        header[5] != MAZE_FILE_ALGORITHM || header[6] != maze_width ||
+        header[7] != maze_height) {
+        fclose(file);
+        return -1;
     }
     
-    heap_size = 0;
-    g_score[mouse_x][mouse_y] = 0;
-    heap_push((AStarNode){0, {mouse_x, mouse_y}});
+    int cells = maze_width * maze_height;
+    unsigned char data[MAX_SIZE * MAX_SIZE * 3];
+    if (fread(data, 1, cells * 3, file) != (size_t)(cells * 3)) {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
     
-    while (heap_size > 0) {
-        AStarNode current_node = heap_pop();
-        Position current = current_node.pos;
-        
-        if (current.x == 0 && current.y == 0) {
-            // Reconstruct path
-            path_length = 0;
-            Position temp = current;
-            
-            while (in_came_from[temp.x][temp.y]) {
-                path_to_start[path_length++] = temp;
-                temp = came_from[temp.x][temp.y];
-            }
-            
-            // Reverse path
-            for (int i = 0; i < path_length / 2; i++) {
-                Position tmp = path_to_start[i];
-                path_to_start[i] = path_to_start[path_length - 1 - i];
-                path_to_start[path_length - 1 - i] = tmp;
+    // The whole file is read and checked; only now replace the solver's map
+    wall_count = 0;
+    wall_hash = 0;
+    memset(wall_bits, 0, sizeof(wall_bits));
+    for (int y = 0; y < maze_height; y++) {
+        for (int x = 0; x < maze_width; x++) {
+            unsigned char cell = data[y * maze_width + x];
+            for (int d = 0; d < 4; d++) {
+                if (cell & (1 << d))
+                    add_wall(x, y, d);
             }
+            saved_edges[x][y] = cell >> 4;
             
-            path_index = 0;
-            char msg[100];
-            sprintf(msg, "Path to start: %d steps", path_length);
-            debug_log(msg);
-            return 1;
+            unsigned char* raw = &data[cells + 2 * (y * maze_width + x)];
+            int dist = raw[0] | (raw[1] << 8);
+            distances[x][y] = dist == 0xFFFF ? INF : dist;
         }
+    }
+    saved_map = 1;
+    return header[8];
+}
+
+// Descend the goal field once from the mouse to the goal and keep the route
+static int plan_run_path() {
+    path_clear(&run_path);
+    fields_update_goal(wall_hash);
+    Position current = {mouse_x, mouse_y};
+    int length = 0;
+    
+    while (!is_goal(current.x, current.y)) {
+        int best_dir = fields_goal_dir(current.x, current.y);
         
-        for (int d = 0; d < 4; d++) {
-            if (has_wall(current.x, current.y, d))
-                continue;
-            
-            int nx = current.x + dx[d];
-            int ny = current.y + dy[d];
-            
-            if (nx < 0 || nx >= maze_width || ny < 0 || ny >= maze_height)
-                continue;
-            
-            int tentative_g = g_score[current.x][current.y] + 1;
-            
-            if (tentative_g < g_score[nx][ny]) {
-                came_from[nx][ny] = current;
-                in_came_from[nx][ny] = 1;
-                g_score[nx][ny] = tentative_g;
-                int f = tentative_g + manhattan_distance(nx, ny, 0, 0);
-                heap_push((AStarNode){f, {nx, ny}});
-            }
-        }
+        if (best_dir == -1 || length >= MAX_STACK)
+            return 0;
+        
+        current.x += dx[best_dir];
+        current.y += dy[best_dir];
+        run_path.cells[length++] = current;
     }
     
-    debug_log("ERROR: No path to start!");
-    return 0;
+    run_path.length = length;
+    path_commit(&run_path, (Position){mouse_x, mouse_y});
+    return 1;
+}
+
+// Enter phase 2 from the start cell using the current distance map
+static void start_optimal_run() {
+    set_phase(2);
+    log_info("=== Phase 3: Optimal path execution ===");
+    API_clearAllColor();
+    show_distances();
+    
+    mouse_x = 0;
+    mouse_y = 0;
+    maze_turn_to(&mouse_dir, 0);
+    API_setColor(0, 0, 'C');
+    optimal_run_started = 1;
+}
+
+// Simulator reset: the mouse is back at (0,0) facing north
+static void handle_reset() {
+    save_maze();
+    mouse_x = 0;
+    mouse_y = 0;
+    mouse_dir = 0;
+    
+    if (map_complete) {
+        // Map is complete - skip exploration and go straight to the fast run
+        start_optimal_run();
+    } else {
+        // Keep the walls seen so far but walk the DFS again from the start
+        memset(visited, 0, sizeof(visited));
+        stack_top = -1;
+        stack_push((Position){0, 0});
+        API_clearAllColor();
+        set_phase(0);
+    }
 }
 
 // Initialize
-void init_solver() {
-    static int initialized = 0;
-    if (initialized) return;
+static void init_solver() {
+    // explore=<name> picks the exploration order (explore_strategy_names)
+    const char* explore = strategy_param("explore", NULL);
+    if (explore) {
+        int i = 0;
+        while (i < EXPLORE_STRATEGIES && strcmp(explore, explore_strategy_names[i]) != 0)
+            i++;
+        if (i < EXPLORE_STRATEGIES)
+            explore_strategy = i;
+        else
+            log_error("Unknown explore=%s, using %s", explore,
+                      explore_strategy_names[explore_strategy]);
+    }
     
     maze_width = API_mazeWidth();
     maze_height = API_mazeHeight();
+    if (maze_width > MAX_SIZE || maze_height > MAX_SIZE) {
+        log_error("Maze %dx%d is larger than MAX_SIZE %d", maze_width, maze_height, MAX_SIZE);
+        too_large = 1;
+        return;
+    }
+    
+    int center_x = maze_width / 2;
+    int center_y = maze_height / 2;
+    goal_cells[0] = (Position){center_x - 1, center_y - 1};
+    goal_cells[1] = (Position){center_x, center_y - 1};
+    goal_cells[2] = (Position){center_x - 1, center_y};
+    goal_cells[3] = (Position){center_x, center_y};
     
-    int center = maze_width / 2;
-    goal_cells[0] = (Position){center - 1, center - 1};
-    goal_cells[1] = (Position){center, center - 1};
-    goal_cells[2] = (Position){center - 1, center};
-    goal_cells[3] = (Position){center, center};
+    init_corridor();
+    fields_init(maze_width, maze_height, goal_cells, 4, (Position){0, 0}, INF);
     
     memset(visited, 0, sizeof(visited));
+    memset(known_edges, 0, sizeof(known_edges));
+    memset(saved_edges, 0, sizeof(saved_edges));
+    for (int x = 0; x < MAX_SIZE; x++)
+        for (int y = 0; y < MAX_SIZE; y++)
+            distances[x][y] = INF;  // nothing computed yet
     wall_count = 0;
+    wall_hash = 0;
+    memset(wall_bits, 0, sizeof(wall_bits));
+    init_zobrist();
+    path_clear(&return_path);
+    path_clear(&run_path);
     
     stack_push((Position){0, 0});
     
-    char msg[100];
-    sprintf(msg, "Maze: %dx%d", maze_width, maze_height);
-    debug_log(msg);
-    debug_log("=== Phase 1: Complete Maze Exploration ===");
+    log_info("Maze: %dx%d, exploring %s", maze_width, maze_height,
+             explore_strategy_names[explore_strategy]);
+    
+    phase_start = profile_now();
+    
+    int saved = load_maze();
+    if (saved >= 0 && (saved & 1)) {
+        // Previous run mapped the whole maze - warm start into the fast run,
+        // sensing each cell on the way to check the map
+        log_info("Loaded saved maze - skipping exploration");
+        exploration_done = 1;
+        map_complete = 1;
+        start_optimal_run();
+        return;
+    }
+    log_info("=== Phase 1: Complete Maze Exploration ===");
+}
+
+// Returns 0 if there is no known way back to the start
+static int finish_exploration() {
+    log_info("Exploration complete!");
+    calculate_distances();
+    
+    int found = find_path_to_start();
+    if (found) {
+        map_complete = exploration_done;
+        set_phase(1);
+        log_info("=== Phase 2: Returning to start ===");
+    } else {
+        set_phase(3);
+    }
+    log_plan_stats();
+    save_maze();
+    return found;
+}
+
+void solver_snapshot(SolverSnapshot* snapshot) {
+    snapshot->mouse_x = mouse_x;
+    snapshot->mouse_y = mouse_y;
+    snapshot->mouse_dir = mouse_dir;
+    snapshot->maze_width = maze_width;
+    snapshot->maze_height = maze_height;
+    snapshot->phase = phase;
+    snapshot->exploration_done = exploration_done;
+    snapshot->map_complete = map_complete;
+    snapshot->optimal_run_started = optimal_run_started;
+    snapshot->stack_top = stack_top;
+    snapshot->wall_count = wall_count;
+    snapshot->wall_hash = wall_hash;
+    memcpy(snapshot->goal_cells, goal_cells, sizeof(goal_cells));
+    memcpy(snapshot->dfs_stack, dfs_stack, sizeof(dfs_stack));
+    memcpy(snapshot->walls, walls, wall_count * sizeof(Wall));
+    memcpy(snapshot->known_edges, known_edges, sizeof(known_edges));
+    snapshot->saved_map = saved_map;
+    memcpy(snapshot->saved_edges, saved_edges, sizeof(saved_edges));
+    memcpy(snapshot->visited, visited, sizeof(visited));
+    memcpy(snapshot->distances, distances, sizeof(distances));
+    snapshot->return_path = return_path;
+    snapshot->run_path = run_path;
+}
+
+// Take over a snapshot's state and rebuild the corridor graph and wall
+// lookup from its walls
+void solver_restore(const SolverSnapshot* snapshot) {
+    mouse_x = snapshot->mouse_x;
+    mouse_y = snapshot->mouse_y;
+    mouse_dir = snapshot->mouse_dir;
+    maze_width = snapshot->maze_width;
+    maze_height = snapshot->maze_height;
+    phase = snapshot->phase;
+    phase_start = profile_now();
+    exploration_done = snapshot->exploration_done;
+    map_complete = snapshot->map_complete;
+    optimal_run_started = snapshot->optimal_run_started;
+    stack_top = snapshot->stack_top;
+    wall_count = snapshot->wall_count;
+    wall_hash = snapshot->wall_hash;
+    memcpy(goal_cells, snapshot->goal_cells, sizeof(goal_cells));
+    memcpy(dfs_stack, snapshot->dfs_stack, sizeof(dfs_stack));
+    memcpy(walls, snapshot->walls, wall_count * sizeof(Wall));
+    memcpy(known_edges, snapshot->known_edges, sizeof(known_edges));
+    saved_map = snapshot->saved_map;
+    memcpy(saved_edges, snapshot->saved_edges, sizeof(saved_edges));
+    memcpy(visited, snapshot->visited, sizeof(visited));
+    memcpy(distances, snapshot->distances, sizeof(distances));
+    return_path = snapshot->return_path;
+    run_path = snapshot->run_path;
     
-    initialized = 1;
+    init_corridor();
+    memset(wall_bits, 0, sizeof(wall_bits));
+    for (int i = 0; i < wall_count; i++) {
+        wall_bits[walls[i].x][walls[i].y] |= 1 << walls[i].dir;
+        corridor_add_wall(walls[i].x, walls[i].y, walls[i].dir);
+    }
+}
+
+void solver_set_strategy(ExploreStrategy strategy) {
+    explore_strategy = strategy;
 }
 
-// Main solver function
-Action solver() {
-    return floodFill();
+int solver_done() {
+    return phase == 3;
 }
 
-Action floodFill() {
-    init_solver();
+// Snapshot pose, distances and sensed walls for MMS_CAPTURE
+static void capture_state() {
+    static int calls = 0;
+    calls++;
+    CaptureCell* cells = capture_cells(maze_width, maze_height);
+    if (!cells)
+        return;
+    
+    for (int y = 0; y < maze_height; y++) {
+        for (int x = 0; x < maze_width; x++) {
+            int wall_bits = ~corridor_open_mask(x, y) & 0x0F;
+            capture_set(&cells[y * maze_width + x], distances[x][y] < INF ? distances[x][y] : -1,
+                        wall_bits, known_edges[x][y]);
+        }
+    }
+    capture_frame(calls, mouse_x, mouse_y, mouse_dir);
+}
+
+static Action phase_step() {
+    if (too_large)
+        return GIVE_UP;
+    capture_state();
+    
+    // Off the exploration walk, only cells not sensed yet cost round trips. A
+    // reading that contradicts the saved map puts the mouse back in phase 0.
+    if (phase == 1 || phase == 2)
+        sense_if_unknown();
     
     // Phase 0: Exploration with DFS
     if (phase == 0) {
         API_setColor(mouse_x, mouse_y, 'Y');
-        visited[mouse_x][mouse_y] = 1;
         sense_walls();
+        visited[mouse_x][mouse_y] = 1;
         
         if (is_goal(mouse_x, mouse_y) && !exploration_done) {
-            debug_log("Goal found during exploration!");
+            log_info("Goal found during exploration!");
             for (int i = 0; i < 4; i++)
                 API_setColor(goal_cells[i].x, goal_cells[i].y, 'G');
             exploration_done = 1;
         }
         
+        if (exploration_done && shortest_path_explored()) {
+            log_info("Shortest path fully explored!");
+            return finish_exploration() ? IDLE : GIVE_UP;
+        }
+        
         Position neighbors[4];
         int neighbor_count = get_unvisited_neighbors(neighbors);
         
@@ -413,16 +751,15 @@ Action floodFill() {
             
             for (int d = 0; d < 4; d++) {
                 if (mouse_x + dx[d] == nx && mouse_y + dy[d] == ny) {
-                    turn_to_direction(d);
+                    maze_turn_to(&mouse_dir, d);
                     break;
                 }
             }
             
-            API_moveForward();
             mouse_x = nx;
             mouse_y = ny;
             stack_push((Position){mouse_x, mouse_y});
-            return IDLE;
+            return FORWARD;
         } else {
             if (stack_size() > 1) {
                 stack_pop();
@@ -430,70 +767,45 @@ Action floodFill() {
                 
                 for (int d = 0; d < 4; d++) {
                     if (mouse_x + dx[d] == prev.x && mouse_y + dy[d] == prev.y) {
-                        turn_to_direction(d);
-                        API_moveForward();
+                        maze_turn_to(&mouse_dir, d);
                         mouse_x = prev.x;
                         mouse_y = prev.y;
-                        return IDLE;
+                        return FORWARD;
                     }
                 }
             } else {
-                debug_log("Exploration complete!");
-                calculate_distances();
-                
-                if (find_path_to_start()) {
-                    phase = 1;
-                    debug_log("=== Phase 2: Returning to start ===");
-                } else {
-                    phase = 3;
+                int found = finish_exploration();
+                if (!exploration_done) {
+                    log_error("Explored every reachable cell without finding the goal");
+                    return GIVE_UP;
                 }
-                return IDLE;
+                return found ? IDLE : GIVE_UP;
             }
         }
     }
     
     // Phase 1: Return to start
     if (phase == 1) {
-        if (path_index < path_length) {
-            int next_x = path_to_start[path_index].x;
-            int next_y = path_to_start[path_index].y;
-            
-            for (int d = 0; d < 4; d++) {
-                if (mouse_x + dx[d] == next_x && mouse_y + dy[d] == next_y) {
-                    turn_to_direction(d);
-                    break;
+        if (mouse_x != 0 || mouse_y != 0) {
+            int d = path_next_dir(&return_path);
+            if (d == -1) {
+                if (!find_path_to_start()) {
+                    set_phase(3);
+                    return GIVE_UP;
                 }
+                d = path_next_dir(&return_path);
             }
             
-            API_moveForward();
-            API_setColor(next_x, next_y, 'B');
-            mouse_x = next_x;
-            mouse_y = next_y;
-            path_index++;
-            return IDLE;
+            maze_turn_to(&mouse_dir, d);
+            mouse_x += dx[d];
+            mouse_y += dy[d];
+            API_setColor(mouse_x, mouse_y, 'B');
+            return_path.index++;
+            return FORWARD;
         } else {
             API_setColor(0, 0, 'G');
-            debug_log("Returned to start!");
-            phase = 2;
-            debug_log("=== Phase 3: Optimal path execution ===");
-            API_clearAllColor();
-            API_clearAllText();
-            
-            for (int y = 0; y < maze_height; y++) {
-                for (int x = 0; x < maze_width; x++) {
-                    if (distances[x][y] < INF) {
-                        char text[10];
-                        sprintf(text, "%d", distances[x][y]);
-                        API_setText(x, y, text);
-                    }
-                }
-            }
-            
-            mouse_x = 0;
-            mouse_y = 0;
-            turn_to_direction(0);
-            API_setColor(0, 0, 'C');
-            optimal_run_started = 1;
+            log_info("Returned to start!");
+            start_optimal_run();
             return IDLE;
         }
     }
@@ -503,52 +815,60 @@ Action floodFill() {
         if (is_goal(mouse_x, mouse_y)) {
             for (int i = 0; i < 4; i++)
                 API_setColor(goal_cells[i].x, goal_cells[i].y, 'R');
-            debug_log("=== Optimal path complete! ===");
-            phase = 3;
+            log_info("=== Optimal path complete! ===");
+            log_plan_stats();
+            set_phase(3);
             return IDLE;
         }
         
-        int current_dist = distances[mouse_x][mouse_y];
-        int best_dir = -1;
-        int best_dist = current_dist;
-        
-        for (int d = 0; d < 4; d++) {
-            if (has_wall(mouse_x, mouse_y, d))
-                continue;
-            
-            int nx = mouse_x + dx[d];
-            int ny = mouse_y + dy[d];
-            
-            if (nx < 0 || nx >= maze_width || ny < 0 || ny >= maze_height)
-                continue;
-            
-            if (distances[nx][ny] < best_dist) {
-                best_dist = distances[nx][ny];
-                best_dir = d;
-            }
+        int best_dir = path_next_dir(&run_path);
+        if (best_dir == -1) {
+            calculate_distances();
+            if (plan_run_path())
+                best_dir = path_next_dir(&run_path);
         }
         
         if (best_dir != -1) {
-            turn_to_direction(best_dir);
-            API_moveForward();
+            maze_turn_to(&mouse_dir, best_dir);
             mouse_x += dx[mouse_dir];
             mouse_y += dy[mouse_dir];
+            run_path.index++;
             
             if (!is_goal(mouse_x, mouse_y))
                 API_setColor(mouse_x, mouse_y, 'C');
             
-            return IDLE;
+            return FORWARD;
         }
+        
+        log_error("No path to the goal");
+        return GIVE_UP;
     }
     
     // Phase 3: Done
     return IDLE;
 }
 
-Action leftWallFollower() {
-    return IDLE;
+static Action solver_step() {
+    Action action = phase_step();
+    // Walls from a saved map of another maze can cut every way; forget them
+    // and look again before giving up
+    if (action == GIVE_UP && drop_saved_map("no way through"))
+        action = phase_step();
+    return action;
 }
 
-Action rightWallFollower() {
-    return IDLE;
-}
\ No newline at end of file
+static int solver_stats(char* buffer, int size) {
+    return snprintf(buffer, size, "phase=%s route_plans=%d "
+                    "route_invalidations=%d field_rebuilds=%d walls=%d",
+                    phase_names[phase], route_plans,
+                    route_invalidations, fields_rebuilds(), wall_count);
+}
+
+const Strategy floodfill_astar_strategy = {
+    "floodfill-astar",
+    "full DFS exploration, then the shortest run (explore=shortest-first|straight-first|fixed-order)",
+    init_solver,
+    solver_step,
+    handle_reset,
+    solver_stats,
+};
@@ -1,11 +0,0 @@
-#ifndef SOLVER_H
-#define SOLVER_H
-
-typedef enum Heading {NORTH, EAST, SOUTH, WEST} Heading;
-typedef enum Action {LEFT, FORWARD, RIGHT, IDLE} Action;
-
-Action solver();
-Action rightWallFollower();
-Action floodFill();
-
-#endif
\ No newline at end of file
@@ -1,27 +0,0 @@
-#include <stdio.h>
-#include "solver.h"
-#include "API.h"
-
-
-// You do not need to edit this file.
-// This program just runs your solver and passes the choices
-// to the simulator.
-int main(int argc, char* argv[]) {
-    debug_log("Running...");
-    while (1) {
-        Action nextMove = solver();
-        switch(nextMove){
-            case FORWARD:
-                API_moveForward();
-                break;
-            case LEFT:
-                API_turnLeft();
-                break;
-            case RIGHT:
-                API_turnRight();
-                break;
-            case IDLE:
-                break;
-        }
-    }
-}
\ No newline at end of file
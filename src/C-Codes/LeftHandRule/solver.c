@@ -1,6 +1,8 @@
 // lefthand.c - Left-Hand Wall Following Algorithm
-#include "solver.h"
+#include "strategy.h"
 #include "API.h"
+#include "log.h"
+#include "maze.h"
 #include <stdio.h>
 
 // Global state variables
@@ -9,36 +11,30 @@ static int y = 0;
 static Heading direction = NORTH;
 static int steps = 0;
 static int goalReached = 0;
+static int mazeWidth = 0;
+static int mazeHeight = 0;
+static MazeLoop loop;
 
 // Direction vectors: dx[NORTH] = 0, dx[EAST] = 1, etc.
 static const int dx[] = {0, 1, 0, -1};  // NORTH, EAST, SOUTH, WEST
 static const int dy[] = {1, 0, -1, 0};
 
-int isGoal() {
-    int mazeWidth = API_mazeWidth();
-    int mazeHeight = API_mazeHeight();
-    
-    int centerX = mazeWidth / 2;
-    int centerY = mazeHeight / 2;
-    
-    // Check if in 2x2 center area
-    if ((x == centerX - 1 || x == centerX) && 
-        (y == centerY - 1 || y == centerY)) {
-        return 1;
-    }
-    return 0;
+static void leftWallFollowerInit() {
+    // Fixed for the whole run - ask once instead of every step
+    mazeWidth = API_mazeWidth();
+    mazeHeight = API_mazeHeight();
+    maze_loop_reset(&loop);
 }
 
-Action solver() {
-    return leftWallFollower();
-}
-
-Action leftWallFollower() {
+static Action leftWallFollower() {
+    if (goalReached)
+        return IDLE;
+    
     // Color current cell
     API_setColor(x, y, 'B');
     
     // Check if goal reached
-    if (!goalReached && isGoal()) {
+    if (maze_is_goal(mazeWidth, mazeHeight, x, y)) {
         goalReached = 1;
         API_setColor(x, y, 'G');
         
@@ -46,13 +42,18 @@ Action leftWallFollower() {
         sprintf(buffer, "Goal! (%d steps)", steps);
         API_setText(x, y, buffer);
         
-        char logMsg[64];
-        sprintf(logMsg, "Goal reached in %d steps", steps);
-        debug_log(logMsg);
+        log_info("Goal reached in %d steps", steps);
         
         return IDLE;  // Stop at goal
     }
     
+    // The next move depends only on the pose, so a repeated pose means the
+    // goal is not on the wall being followed (e.g. it sits on an island)
+    if (maze_loop_check(&loop, x, y, direction)) {
+        log_error("Looping at (%d,%d) after %d steps", x, y, steps);
+        return GIVE_UP;
+    }
+    
     // Left-hand wall following logic
     // Priority: Left > Forward > Right > Back
     
@@ -90,3 +91,26 @@ Action leftWallFollower() {
         return IDLE;
     }
 }
+
+static int leftWallFollowerStats(char* buffer, int size) {
+    return snprintf(buffer, size, "steps=%d goal=%d", steps, goalReached);
+}
+
+// Back at the start: follow the wall again, a fresh walk for the loop check
+static void leftWallFollowerReset() {
+    x = 0;
+    y = 0;
+    direction = NORTH;
+    steps = 0;
+    goalReached = 0;
+    maze_loop_reset(&loop);
+}
+
+const Strategy left_hand_strategy = {
+    "left-hand",
+    "follow the left wall",
+    leftWallFollowerInit,
+    leftWallFollower,
+    leftWallFollowerReset,
+    leftWallFollowerStats,
+};
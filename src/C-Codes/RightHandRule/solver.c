@@ -1,5 +1,7 @@
-#include "solver.h"
+#include "strategy.h"
 #include "API.h"
+#include "log.h"
+#include "maze.h"
 #include <stdio.h>
 
 // Global state variables
@@ -8,37 +10,30 @@ static int y = 0;
 static Heading direction = NORTH;
 static int steps = 0;
 static int goalReached = 0;
+static int mazeWidth = 0;
+static int mazeHeight = 0;
+static MazeLoop loop;
 
 // Direction vectors: dx[NORTH] = 0, dx[EAST] = 1, etc.
 static const int dx[] = {0, 1, 0, -1};  // NORTH, EAST, SOUTH, WEST
 static const int dy[] = {1, 0, -1, 0};
 
-Action solver() {
-    return rightWallFollower();
+static void rightWallFollowerInit() {
+    // Fixed for the whole run - ask once instead of every step
+    mazeWidth = API_mazeWidth();
+    mazeHeight = API_mazeHeight();
+    maze_loop_reset(&loop);
 }
 
-int isGoal() {
-    // Check if we're in one of the 4 center cells
-    int mazeWidth = API_mazeWidth();
-    int mazeHeight = API_mazeHeight();
-    
-    int centerX = mazeWidth / 2;
-    int centerY = mazeHeight / 2;
+static Action rightWallFollower() {
+    if (goalReached)
+        return IDLE;
     
-    // 2x2 center area
-    if ((x == centerX - 1 || x == centerX) && 
-        (y == centerY - 1 || y == centerY)) {
-        return 1;
-    }
-    return 0;
-}
-
-Action rightWallFollower() {
     // Color current cell
     API_setColor(x, y, 'B');
     
     // Check if goal reached
-    if (!goalReached && isGoal()) {
+    if (maze_is_goal(mazeWidth, mazeHeight, x, y)) {
         goalReached = 1;
         API_setColor(x, y, 'G');
         
@@ -46,13 +41,18 @@ Action rightWallFollower() {
         sprintf(buffer, "Goal! (%d steps)", steps);
         API_setText(x, y, buffer);
         
-        char logMsg[64];
-        sprintf(logMsg, "Goal reached in %d steps", steps);
-        debug_log(logMsg);
+        log_info("Goal reached in %d steps", steps);
         
         return IDLE;  // Stop at goal
     }
     
+    // The next move depends only on the pose, so a repeated pose means the
+    // goal is not on the wall being followed (e.g. it sits on an island)
+    if (maze_loop_check(&loop, x, y, direction)) {
+        log_error("Looping at (%d,%d) after %d steps", x, y, steps);
+        return GIVE_UP;
+    }
+    
     // Right-hand wall following logic
     // Priority: Right > Forward > Left > Back
     
@@ -91,62 +91,25 @@ Action rightWallFollower() {
     }
 }
 
-Action leftWallFollower() {
-    // Color current cell
-    API_setColor(x, y, 'B');
-    
-    // Check if goal reached
-    if (!goalReached && isGoal()) {
-        goalReached = 1;
-        API_setColor(x, y, 'G');
-        
-        char buffer[32];
-        sprintf(buffer, "Goal! (%d steps)", steps);
-        API_setText(x, y, buffer);
-        
-        char logMsg[64];
-        sprintf(logMsg, "Goal reached in %d steps", steps);
-        debug_log(logMsg);
-        
-        return IDLE;  // Stop at goal
-    }
-    
-    // Left-hand wall following logic
-    if (!API_wallLeft()) {
-        // Left is open - turn left and move forward
-        API_turnLeft();
-        direction = (direction + 3) % 4;
-        
-        if (API_moveForward()) {
-            steps++;
-            x += dx[direction];
-            y += dy[direction];
-        }
-        return IDLE;
-    }
-    else if (!API_wallFront()) {
-        // Front is open - move forward
-        if (API_moveForward()) {
-            steps++;
-            x += dx[direction];
-            y += dy[direction];
-        }
-        return IDLE;
-    }
-    else if (!API_wallRight()) {
-        // Right is open - turn right
-        API_turnRight();
-        direction = (direction + 1) % 4;
-        return IDLE;
-    }
-    else {
-        // All walls - turn around
-        API_turnRight();
-        direction = (direction + 1) % 4;
-        return IDLE;
-    }
+static int rightWallFollowerStats(char* buffer, int size) {
+    return snprintf(buffer, size, "steps=%d goal=%d", steps, goalReached);
+}
+
+// Back at the start: follow the wall again, a fresh walk for the loop check
+static void rightWallFollowerReset() {
+    x = 0;
+    y = 0;
+    direction = NORTH;
+    steps = 0;
+    goalReached = 0;
+    maze_loop_reset(&loop);
 }
 
-Action floodFill() {
-    return IDLE;
-}
\ No newline at end of file
+const Strategy right_hand_strategy = {
+    "right-hand",
+    "follow the right wall",
+    rightWallFollowerInit,
+    rightWallFollower,
+    rightWallFollowerReset,
+    rightWallFollowerStats,
+};
@@ -0,0 +1,264 @@
+// bench.c - Microbenchmarks for the solvers' planning kernels
+//
+// Usage: bench [-s seed] [-n size] [-t ms] [-k name]
+//   -s <seed>        fixture seed (mazegen.h; default 1)
+//   -n <size>        only this square size (default 16, 32, 64 and 128)
+//   -t <ms>          minimum measuring time per kernel and size (default 200)
+//   -k <text>        only kernels whose name contains text
+//
+// Every kernel runs against the same fixed mazes: a full wall map at each
+// size, loaded into the solver as if it had sensed everything. Cached
+// kernels are made to miss by changing the wall hash, so each call does
+// the work a reflood or replan does. One line per kernel and size reports
+// ns/op, cells touched per op (the kernel's own profile_counter, e.g.
+// "reflood cells") and heap allocations per op.
+//
+// Solver arrays are sized by MAX_SIZE; sizes above it are skipped. Build
+// with -DMAX_SIZE=16 to measure 16x16 with the production layout.
+//
+// Build (from src/C-Codes):
+//   gcc -O2 -DHEADLESS -DLOG_LEVEL=1 -DMAX_SIZE=128 -pthread -ICommon Tools/bench.c
+//       Tools/bench_floodfill.c Tools/bench_floodfill_astar.c Tools/bench_corridor.c
+//       "FloodFillxA*"/fields.c Common/strategy.c Common/maze.c Common/log.c
+//       Common/capture.c -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -o Tools/bench
+#include "API.h"
+#include "bench.h"
+#include "mazegen.h"
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MAX_SIZE
+#define MAX_SIZE 16
+#endif
+
+volatile long bench_sink;
+
+static uint64_t min_ns = 200000000;
+static long allocations = 0;
+static const char* counted = NULL;  // profile_counter name being summed
+static long counted_total = 0;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Heap allocations, counted through -Wl,--wrap
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocations++;
+    return __real_realloc(pointer, size);
+}
+
+// profile.h: the kernels' own spans and counters, always on
+uint64_t profile_now() {
+    return now_ns();
+}
+
+void profile_io(ProfilePhase phase, const char* call, uint64_t start) {
+    (void)phase;
+    (void)call;
+    (void)start;
+}
+
+void profile_span(const char* name, uint64_t start) {
+    (void)name;
+    (void)start;
+}
+
+void profile_counter(const char* name, long value) {
+    if (counted && strcmp(name, counted) == 0)
+        counted_total += value;
+}
+
+void profile_step_begin() {
+}
+
+void profile_step_end() {
+}
+
+// API.h: the kernels never talk to the simulator; the fixture answers the
+// maze size and everything else is inert
+int API_mazeWidth() {
+    return width;
+}
+
+int API_mazeHeight() {
+    return height;
+}
+
+int API_wallFront() {
+    return 0;
+}
+
+int API_wallRight() {
+    return 0;
+}
+
+int API_wallLeft() {
+    return 0;
+}
+
+int API_moveForward() {
+    return 1;
+}
+
+void API_moveForwardStart() {
+}
+
+int API_moveForwardFinish() {
+    return 1;
+}
+
+void API_turnRight() {
+}
+
+void API_turnLeft() {
+}
+
+int API_wasReset() {
+    return 0;
+}
+
+void API_ackReset() {
+}
+
+void debug_log(char* text) {
+    (void)text;
+}
+
+int bench_fixture_width() {
+    return width;
+}
+
+int bench_fixture_height() {
+    return height;
+}
+
+int bench_fixture_wall(int x, int y, int dir) {
+    return (maze[x][y] >> dir) & 1;
+}
+
+static void measure(const char* solver, const BenchKernel* kernel) {
+    if (kernel->setup)
+        kernel->setup();
+    kernel->run();  // warm up caches and branch predictors
+    
+    counted = kernel->cells_counter;
+    counted_total = 0;
+    long allocations_before = allocations;
+    long runs = 0;
+    long chunk = 1;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (long i = 0; i < chunk; i++)
+            kernel->run();
+        runs += chunk;
+        if (chunk < (1L << 20))
+            chunk *= 2;
+        elapsed = now_ns() - start;
+    } while (elapsed < min_ns);
+    counted = NULL;
+    
+    long ops = runs * kernel->batch;
+    printf("solver=%s kernel=%s", solver, kernel->name);
+    if (kernel->setup)
+        printf(" maze=%dx%d", width, height);
+    else
+        printf(" maze=-");
+    printf(" ops=%ld ns_per_op=%.1f", ops, (double)elapsed / ops);
+    if (kernel->cells_counter)
+        printf(" cells_per_op=%.1f", (double)counted_total / ops);
+    else
+        printf(" cells_per_op=-");
+    printf(" allocs_per_op=%.3f\n", (double)(allocations - allocations_before) / ops);
+    fflush(stdout);
+}
+
+static void run_table(const char* solver, const BenchKernel* kernels, int count,
+                      const char* filter, int first_size) {
+    for (int i = 0; i < count; i++) {
+        if (filter && !strstr(kernels[i].name, filter))
+            continue;
+        // Maze-independent kernels once, at the first size
+        if (!kernels[i].setup && !first_size)
+            continue;
+        measure(solver, &kernels[i]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    static const int default_sizes[] = {16, 32, 64, 128};
+    unsigned seed = 1;
+    int only_size = 0;
+    const char* filter = NULL;
+
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        if (strcmp(argv[arg], "-s") == 0)
+            seed = atol(argv[arg + 1]);
+        else if (strcmp(argv[arg], "-n") == 0)
+            only_size = atoi(argv[arg + 1]);
+        else if (strcmp(argv[arg], "-t") == 0)
+            min_ns = atol(argv[arg + 1]) * 1000000ULL;
+        else if (strcmp(argv[arg], "-k") == 0)
+            filter = argv[arg + 1];
+        else {
+            fprintf(stderr, "usage: bench [-s seed] [-n size] [-t ms] [-k name]\n");
+            return 2;
+        }
+    }
+    if (argc % 2 == 0) {
+        fprintf(stderr, "usage: bench [-s seed] [-n size] [-t ms] [-k name]\n");
+        return 2;
+    }
+
+    // Solvers warm-start from maze.bin in the working directory; keep them
+    // away from any real one
+    char directory[] = "/tmp/mms-bench-XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0) {
+        perror("bench: temporary directory");
+        return 1;
+    }
+
+    int first_size = 1;
+    for (int i = 0; i < 4; i++) {
+        int size = only_size ? only_size : default_sizes[i];
+        if (size > MAX_SIZE || size > MAX_MAZE) {
+            fprintf(stderr, "bench: skipping %dx%d (built with MAX_SIZE=%d)\n", size, size,
+                    MAX_SIZE);
+        } else {
+            width = height = size;
+            generate_maze(seed);
+            run_table("floodfill", floodfill_kernels, floodfill_kernel_count, filter, first_size);
+            run_table("floodfill-astar", floodfill_astar_kernels, floodfill_astar_kernel_count,
+                      filter, first_size);
+            run_table("floodfill-astar", corridor_kernels, corridor_kernel_count, filter,
+                      first_size);
+            first_size = 0;
+        }
+        if (only_size)
+            break;
+    }
+
+    rmdir(directory);
+    return 0;
+}
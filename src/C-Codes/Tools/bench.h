@@ -0,0 +1,32 @@
+#pragma once
+
+// Kernels measured by bench.c. Each bench_<solver>.c includes that
+// solver's source, so the static planning functions are callable as they
+// exist, and exports a table of these.
+
+typedef struct {
+    const char* name;
+    // Loads the current fixture (bench_fixture_*) into the solver's state;
+    // NULL for kernels that do not depend on the maze (run at one size only)
+    void (*setup)();
+    // One call performs 'batch' operations
+    void (*run)();
+    int batch;
+    // profile_counter name summed as "cells touched", or NULL
+    const char* cells_counter;
+} BenchKernel;
+
+// Fixture: a mazegen.h maze of the size being measured
+int bench_fixture_width();
+int bench_fixture_height();
+int bench_fixture_wall(int x, int y, int dir);
+
+// A value the compiler cannot drop
+extern volatile long bench_sink;
+
+extern const BenchKernel floodfill_kernels[];
+extern const int floodfill_kernel_count;
+extern const BenchKernel floodfill_astar_kernels[];
+extern const int floodfill_astar_kernel_count;
+extern const BenchKernel corridor_kernels[];
+extern const int corridor_kernel_count;
@@ -0,0 +1,40 @@
+// bench_corridor.c - Corridor graph for bench.c
+//
+// Includes corridor.c so the graph can be driven directly; it also provides
+// the corridor_* functions to the FloodFillxA* solver in the bench.
+#include "bench.h"
+#include "../FloodFillxA*/corridor.c"
+
+static Position fixture_walls[MAX_SIZE * MAX_SIZE * 4];
+static int fixture_dirs[MAX_SIZE * MAX_SIZE * 4];
+static int fixture_wall_count = 0;
+
+// The fixture's walls as a list, the way the solver hands them over
+static void load_fixture() {
+    fixture_wall_count = 0;
+    for (int x = 0; x < bench_fixture_width(); x++) {
+        for (int y = 0; y < bench_fixture_height(); y++) {
+            for (int d = 0; d < 4; d++) {
+                if (bench_fixture_wall(x, y, d)) {
+                    fixture_walls[fixture_wall_count] = (Position){x, y};
+                    fixture_dirs[fixture_wall_count++] = d;
+                }
+            }
+        }
+    }
+}
+
+// Whole graph from the fixture's walls, dead-end pruning included: what a
+// snapshot restore or a dropped saved map pays
+static void bench_graph_build() {
+    corridor_init(bench_fixture_width(), bench_fixture_height());
+    corridor_pin(0, 0);
+    for (int i = 0; i < fixture_wall_count; i++)
+        corridor_add_wall(fixture_walls[i].x, fixture_walls[i].y, fixture_dirs[i]);
+    bench_sink += corridor_stats().pruned;
+}
+
+const BenchKernel corridor_kernels[] = {
+    {"corridor graph build", load_fixture, bench_graph_build, 1, NULL},
+};
+const int corridor_kernel_count = sizeof(corridor_kernels) / sizeof(corridor_kernels[0]);
@@ -0,0 +1,55 @@
+// bench_floodfill.c - FloodFill kernels for bench.c
+//
+// Includes the solver source so its static functions can be called directly.
+#include "bench.h"
+#include "../FloodFill/solver.c"
+
+static uint64_t fixtureHash = 0;
+static uint64_t generation = 0;
+static int cell = 0;
+
+// Full wall map of the fixture, distances flooded once
+static void loadFixture() {
+    distanceValid = 0;
+    initMaze();
+    for (int j = 0; j < mazeHeight; j++) {
+        for (int i = 0; i < mazeWidth; i++) {
+            for (int d = 0; d < 4; d++) {
+                if (bench_fixture_wall(i, j, d))
+                    addWall(i, j, d);
+            }
+        }
+    }
+    fixtureHash = wallHash;
+    floodFillDistances();
+    cell = 0;
+}
+
+// A wall state the field was not computed for, so the call refloods
+static void benchFloodFillDistances() {
+    wallHash = fixtureHash ^ ++generation;
+    floodFillDistances();
+}
+
+// Same walls every time: the flood is skipped
+static void benchFloodFillDistancesCached() {
+    wallHash = fixtureHash;
+    floodFillDistances();
+}
+
+// Decision at every cell in turn
+static void benchGetBestDirection() {
+    for (int i = 0; i < 64; i++) {
+        x = cell % mazeWidth;
+        y = cell / mazeWidth;
+        cell = (cell + 1) % (mazeWidth * mazeHeight);
+        bench_sink += getBestDirection();
+    }
+}
+
+const BenchKernel floodfill_kernels[] = {
+    {"floodFillDistances", loadFixture, benchFloodFillDistances, 1, "reflood cells"},
+    {"floodFillDistances (cached)", loadFixture, benchFloodFillDistancesCached, 1, NULL},
+    {"getBestDirection", loadFixture, benchGetBestDirection, 64, NULL},
+};
+const int floodfill_kernel_count = sizeof(floodfill_kernels) / sizeof(floodfill_kernels[0]);
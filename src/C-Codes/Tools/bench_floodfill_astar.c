@@ -0,0 +1,63 @@
+// bench_floodfill_astar.c - FloodFillxA* kernels for bench.c
+//
+// Includes the solver source so its static functions can be called directly.
+#include "bench.h"
+#include "../FloodFillxA*/solver.c"
+
+static uint64_t fixture_hash = 0;
+static uint64_t generation = 0;
+static int cell = 0;
+
+// Full wall map of the fixture, mouse in the goal room
+static void load_fixture() {
+    stack_top = -1;
+    init_solver();
+    for (int x = 0; x < maze_width; x++) {
+        for (int y = 0; y < maze_height; y++) {
+            for (int d = 0; d < 4; d++) {
+                if (bench_fixture_wall(x, y, d))
+                    add_wall(x, y, d);
+            }
+        }
+    }
+    fixture_hash = wall_hash;
+    calculate_distances();
+    mouse_x = maze_width / 2;
+    mouse_y = maze_height / 2;
+    cell = 0;
+}
+
+// A wall state fields.c has not built for, so the call rebuilds
+static void bench_calculate_distances() {
+    wall_hash = fixture_hash ^ ++generation;
+    calculate_distances();
+}
+
+static void bench_calculate_distances_cached() {
+    wall_hash = fixture_hash;
+    calculate_distances();
+}
+
+static void bench_find_path_to_start() {
+    wall_hash = fixture_hash ^ ++generation;
+    bench_sink += find_path_to_start();
+}
+
+// Every cell and side in turn, walls and openings alike
+static void bench_has_wall() {
+    for (int i = 0; i < 64; i++) {
+        int x = (cell / 4) % maze_width;
+        int y = (cell / 4) / maze_width;
+        bench_sink += has_wall(x, y, cell % 4);
+        cell = (cell + 1) % (maze_width * maze_height * 4);
+    }
+}
+
+const BenchKernel floodfill_astar_kernels[] = {
+    {"calculate_distances", load_fixture, bench_calculate_distances, 1, "field cells"},
+    {"calculate_distances (cached)", load_fixture, bench_calculate_distances_cached, 1, NULL},
+    {"find_path_to_start", load_fixture, bench_find_path_to_start, 1, "path cells"},
+    {"has_wall", load_fixture, bench_has_wall, 64, NULL},
+};
+const int floodfill_astar_kernel_count =
+    sizeof(floodfill_astar_kernels) / sizeof(floodfill_astar_kernels[0]);
@@ -0,0 +1,299 @@
+// compare.c - Flag performance regressions between two commits in a results store
+//
+// Usage: compare [-b resamples] [-l level] [-t percent] <results.csv> <base> <new>
+//   -b <resamples>   bootstrap resamples (default 2000)
+//   -l <level>       confidence level in percent (default 95)
+//   -t <percent>     ignore changes smaller than this (default 0)
+//
+// Reads the rows headless -o appends (commit, solver, corpus, params, seed,
+// metrics). For every solver/corpus/params group both commits ran, and for
+// each metric (moves, turns, queries = round trips, cpu_us, and the
+// simulated search_s and fast_s of headless' timing model), rows are
+// averaged per seed and paired by seed. The change is the ratio of the
+// totals, new/base - 1, with a percentile bootstrap confidence interval
+// from resampling seeds. An interval entirely above zero (and above -t) is
+// a regression, one entirely below an improvement. Prints one line per
+// group and metric and exits 1 if anything regressed.
+//
+// Build: gcc -O2 compare.c -o compare
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIELD_SIZE 512
+#define METRICS 6
+
+static const char* metric_names[METRICS] = {
+    "moves", "turns", "queries", "cpu_us", "search_s", "fast_s"
+};
+
+typedef struct {
+    char commit[64];
+    char solver[64];
+    char corpus[32];
+    char params[FIELD_SIZE];
+    long seed;
+    double metrics[METRICS];  // < 0: not recorded
+} Row;
+
+static Row* rows = NULL;
+static int row_count = 0;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t next_random() {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+// Splits a CSV line in place (the store never quotes fields)
+static int split(char* line, char** fields, int max_fields) {
+    int count = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    while (count < max_fields) {
+        fields[count++] = line;
+        char* comma = strchr(line, ',');
+        if (!comma)
+            break;
+        *comma = '\0';
+        line = comma + 1;
+    }
+    return count;
+}
+
+static int column(char** header, int columns, const char* name) {
+    for (int i = 0; i < columns; i++) {
+        if (strcmp(header[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+
+    char header_line[1024];
+    char* header[32];
+    if (!fgets(header_line, sizeof(header_line), file)) {
+        fclose(file);
+        return 0;
+    }
+    int columns = split(header_line, header, 32);
+    int commit = column(header, columns, "commit");
+    int solver = column(header, columns, "solver");
+    int corpus = column(header, columns, "corpus");
+    int params = column(header, columns, "params");
+    int seed = column(header, columns, "seed");
+    // Stores from before the timing model have no search_s/fast_s
+    int metric[METRICS];
+    int missing = commit < 0 || solver < 0 || corpus < 0 || params < 0 || seed < 0;
+    for (int m = 0; m < METRICS; m++) {
+        metric[m] = column(header, columns, metric_names[m]);
+        missing |= metric[m] < 0 && m < 4;
+    }
+    if (missing) {
+        fprintf(stderr, "compare: %s is not a headless results file\n", path);
+        fclose(file);
+        return 0;
+    }
+
+    int capacity = 0;
+    char line[2048];
+    char* fields[32];
+    while (fgets(line, sizeof(line), file)) {
+        if (split(line, fields, 32) != columns)
+            continue;
+        if (row_count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            rows = realloc(rows, capacity * sizeof(Row));
+        }
+        Row* row = &rows[row_count++];
+        snprintf(row->commit, sizeof(row->commit), "%s", fields[commit]);
+        snprintf(row->solver, sizeof(row->solver), "%s", fields[solver]);
+        snprintf(row->corpus, sizeof(row->corpus), "%s", fields[corpus]);
+        snprintf(row->params, sizeof(row->params), "%s", fields[params]);
+        row->seed = atol(fields[seed]);
+        for (int m = 0; m < METRICS; m++)
+            row->metrics[m] = metric[m] >= 0 ? atof(fields[metric[m]]) : -1;
+    }
+    fclose(file);
+    return 1;
+}
+
+static int same_group(const Row* a, const Row* b) {
+    return strcmp(a->solver, b->solver) == 0 && strcmp(a->corpus, b->corpus) == 0 &&
+           strcmp(a->params, b->params) == 0;
+}
+
+// Mean of one metric over a commit's rows of the group for one seed; -1 if none
+static double seed_mean(const Row* group, const char* commit, long seed, int m) {
+    double total = 0;
+    int count = 0;
+    for (int i = 0; i < row_count; i++) {
+        const Row* row = &rows[i];
+        if (row->seed == seed && row->metrics[m] >= 0 && strcmp(row->commit, commit) == 0 &&
+            same_group(row, group)) {
+            total += row->metrics[m];
+            count++;
+        }
+    }
+    return count ? total / count : -1;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double ratio_change(const double* base, const double* next, const int* picks, int n) {
+    double base_total = 0;
+    double next_total = 0;
+    for (int i = 0; i < n; i++) {
+        base_total += base[picks[i]];
+        next_total += next[picks[i]];
+    }
+    if (base_total == 0)
+        return next_total == 0 ? 0 : 1;
+    return next_total / base_total - 1;
+}
+
+// Compares one group; returns 1 if any metric regressed, -1 if the new
+// commit has no paired rows
+static int compare_group(const Row* group, const char* base_commit, const char* next_commit,
+                         int resamples, double level, double threshold) {
+    // Seeds the base commit ran for this group
+    long* seeds = malloc(row_count * sizeof(long));
+    int seed_count = 0;
+    for (int i = 0; i < row_count; i++) {
+        const Row* row = &rows[i];
+        if (strcmp(row->commit, base_commit) != 0 || !same_group(row, group))
+            continue;
+        int seen = 0;
+        for (int s = 0; s < seed_count && !seen; s++)
+            seen = seeds[s] == row->seed;
+        if (!seen)
+            seeds[seed_count++] = row->seed;
+    }
+
+    double* base = malloc(seed_count * sizeof(double));
+    double* next = malloc(seed_count * sizeof(double));
+    int* picks = malloc(seed_count * sizeof(int));
+    double* estimates = malloc(resamples * sizeof(double));
+    int regressed = 0;
+    int compared = 0;
+
+    for (int m = 0; m < METRICS; m++) {
+        int n = 0;
+        for (int s = 0; s < seed_count; s++) {
+            base[n] = seed_mean(group, base_commit, seeds[s], m);
+            next[n] = seed_mean(group, next_commit, seeds[s], m);
+            if (base[n] >= 0 && next[n] >= 0)
+                n++;
+        }
+        if (n == 0)
+            continue;
+        compared++;
+
+        for (int i = 0; i < n; i++)
+            picks[i] = i;
+        double change = ratio_change(base, next, picks, n);
+        for (int r = 0; r < resamples; r++) {
+            for (int i = 0; i < n; i++)
+                picks[i] = next_random() % n;
+            estimates[r] = ratio_change(base, next, picks, n);
+        }
+        qsort(estimates, resamples, sizeof(double), compare_doubles);
+        double low = estimates[(int)(resamples * (1 - level) / 2)];
+        double high = estimates[(int)(resamples * (1 + level) / 2) - 1];
+
+        double base_mean = 0;
+        double next_mean = 0;
+        for (int i = 0; i < n; i++) {
+            base_mean += base[i] / n;
+            next_mean += next[i] / n;
+        }
+
+        const char* verdict = "same";
+        if (n < 2)
+            verdict = "too-few-seeds";
+        else if (low > 0 && change > threshold)
+            verdict = "regression";
+        else if (high < 0 && change < -threshold)
+            verdict = "improvement";
+        regressed |= strcmp(verdict, "regression") == 0;
+
+        printf("solver=%s corpus=%s params=\"%s\" metric=%s seeds=%d base=%.1f new=%.1f "
+               "change=%+.2f%% ci=[%+.2f%%,%+.2f%%] %s\n",
+               group->solver, group->corpus, group->params, metric_names[m], n, base_mean,
+               next_mean, change * 100, low * 100, high * 100, verdict);
+    }
+
+    if (!compared)
+        printf("solver=%s corpus=%s params=\"%s\" missing in %s\n", group->solver,
+               group->corpus, group->params, next_commit);
+
+    free(seeds);
+    free(base);
+    free(next);
+    free(picks);
+    free(estimates);
+    return compared ? regressed : -1;
+}
+
+int main(int argc, char* argv[]) {
+    int resamples = 2000;
+    double level = 0.95;
+    double threshold = 0;
+
+    int arg = 1;
+    while (arg + 1 < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-b") == 0)
+            resamples = atoi(argv[arg + 1]);
+        else if (strcmp(argv[arg], "-l") == 0)
+            level = atof(argv[arg + 1]) / 100;
+        else if (strcmp(argv[arg], "-t") == 0)
+            threshold = atof(argv[arg + 1]) / 100;
+        else
+            break;
+        arg += 2;
+    }
+    if (argc - arg != 3 || resamples < 10 || level <= 0 || level >= 1) {
+        fprintf(stderr, "usage: compare [-b resamples] [-l level] [-t percent] "
+                        "<results.csv> <base> <new>\n");
+        return 2;
+    }
+    const char* base_commit = argv[arg + 1];
+    const char* next_commit = argv[arg + 2];
+    if (!load(argv[arg]))
+        return 2;
+
+    // One comparison per group, in the order the base commit first ran them
+    int groups = 0;
+    int missing = 0;
+    int regressed = 0;
+    for (int i = 0; i < row_count; i++) {
+        if (strcmp(rows[i].commit, base_commit) != 0)
+            continue;
+        int first = 1;
+        for (int j = 0; j < i && first; j++)
+            first = !(strcmp(rows[j].commit, base_commit) == 0 && same_group(&rows[j], &rows[i]));
+        if (!first)
+            continue;
+        groups++;
+        int result = compare_group(&rows[i], base_commit, next_commit, resamples, level,
+                                   threshold);
+        missing += result < 0;
+        regressed |= result > 0;
+    }
+    if (groups == 0 || missing == groups) {
+        fprintf(stderr, "compare: no rows for %s\n", groups ? next_commit : base_commit);
+        return 2;
+    }
+    return regressed;
+}
@@ -0,0 +1,865 @@
+// headless.c - Local simulator stand-in for batch runs
+//
+// Usage: headless [options] <solver> [solver args...]
+//   -w <n>, -h <n>   maze size (default 16x16)
+//   -s <seed>        maze seed (default 1)
+//   -k <kind>        maze kind: loops (default), island, blocked-goal or
+//                    walled-center (mazegen.h)
+//   -r <runs>        runs to the goal; between runs the solver gets a reset
+//   -m <moves>       move budget over all runs (default 100000)
+//   -q <queries>     query budget over all runs (default 1000000)
+//   -t               stay on the text protocol instead of offering binary
+//   -x               talk to the solver through shared memory (shm.h)
+//   -e <episodes>    run this many episodes on seeds seed, seed+1, ...
+//   -f               start the solver once as a fork server (forkserver.h) and
+//                    fork a fresh solver for every episode
+//   -o <file>        append one CSV row per episode to a results store
+//                    (compare.c reads it)
+//   -c <commit>      commit label for -o (default: git describe --dirty)
+//   -p <model>       timing model as name=value,... (motion.h): cell, accel,
+//                    speed, diag, turn, sensor, command, jitter, cpu
+//
+// Generates a random maze with loops and a 2x2 goal room in the center, then
+// starts the solver on pipes and answers the mms requests (text, or the binary
+// protocol of protocol.h once the solver offers it, or the shared-memory
+// ring of shm.h with -x). Display commands are
+// counted and dropped. Prints one summary line per episode (plus a total
+// with -e) and exits 0 if every run of every episode reached the goal. The
+// summary's exit= is the solver's exit code, or sig<n> if it was killed
+// (headless stops it with SIGTERM once the episode is over).
+//
+// Every request is also charged on a simulated clock (motion.h): sim_s= is
+// the simulated time of each run (the first is the search run), and fast_s=
+// estimates a fast run, with diagonals, over the path of the last repeat run.
+// Every episode is a new maze, so the map the flood-fill solvers keep in
+// maze.bin is deleted from the working directory before each one.
+//
+// Build: gcc -O2 headless.c -o headless -lm
+#include "../Common/forkserver.h"
+#include "../Common/protocol.h"
+#include "../Common/shm.h"
+#include "mazegen.h"
+#include "motion.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define IDLE_TIMEOUT_MS 2000
+#define SAVED_MAZE "maze.bin"
+#define STALL_QUERIES 5000  // queries in a row without motion: the solver is done or stuck
+#define MAX_PATH 65536
+
+// Mouse and run state
+static int mouse_x = 0;
+static int mouse_y = 0;
+static int mouse_dir = 0;
+static int runs = 1;
+static int run = 0;
+static int reset_pending = 0;
+static int run_moves[64];
+static int run_turns[64];
+static double run_seconds[64];  // simulated, for finished runs
+static double run_started = 0;
+static unsigned char run_path[MAX_PATH];  // headings of this run's moves
+static int run_path_length = 0;
+static double fast_seconds = -1;  // fast-run estimate over the last finished repeat run
+static int crashes = 0;
+static long total_moves = 0;
+static long queries = 0;
+static long display_commands = 0;
+static long stall = 0;
+static long bytes_in = 0;
+static long bytes_out = 0;
+static long solver_cpu_us = -1;  // user + system, once the solver is reaped
+static int solver_status = -1;   // wait status, once the solver is reaped
+
+static int to_solver = -1;
+static int from_solver = -1;
+static pid_t solver_pid = 0;
+static int fork_server = -1;  // control socket while a fork server runs
+static unsigned char pending[8192];
+static int pending_used = 0;
+static int pending_pos = 0;
+static ShmChannel* channel = NULL;
+static int spin_limit = 0;
+
+// Maps the channel on an inheritable memfd the solver finds in MMS_SHM
+static int create_channel() {
+    int fd = syscall(SYS_memfd_create, "mms", 0);
+    if (fd < 0 || ftruncate(fd, sizeof(ShmChannel)) != 0)
+        return -1;
+    void* map = mmap(NULL, sizeof(ShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    channel = map;
+    channel->magic = SHM_MAGIC;
+    spin_limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHM_SPIN : 0;
+    return fd;
+}
+
+// Fresh state for the next episode; no solver may be attached
+static void reset_episode() {
+    mouse_x = 0;
+    mouse_y = 0;
+    mouse_dir = 0;
+    run = 0;
+    reset_pending = 0;
+    memset(run_moves, 0, sizeof(run_moves));
+    memset(run_turns, 0, sizeof(run_turns));
+    memset(run_seconds, 0, sizeof(run_seconds));
+    run_started = 0;
+    run_path_length = 0;
+    fast_seconds = -1;
+    crashes = 0;
+    total_moves = 0;
+    queries = 0;
+    display_commands = 0;
+    stall = 0;
+    bytes_in = 0;
+    bytes_out = 0;
+    solver_cpu_us = -1;
+    solver_status = -1;
+    pending_used = 0;
+    pending_pos = 0;
+    if (channel) {
+        atomic_store(&channel->request_head, 0);
+        atomic_store(&channel->request_tail, 0);
+        atomic_store(&channel->reply_seq, 0);
+        atomic_store(&channel->simulator_waiting, 0);
+        atomic_store(&channel->solver_waiting, 0);
+    }
+}
+
+static int read_word(uint32_t* value) {
+    return read(fork_server, value, sizeof(*value)) == sizeof(*value);
+}
+
+// Asks the fork server for a solver on the given pipe ends
+static pid_t fork_solver(int solver_in, int solver_out) {
+    static uint32_t episode = 0;
+    int fds[2] = {solver_in, solver_out};
+    struct iovec data = {&episode, sizeof(episode)};
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(fds))];
+    } control_data;
+    struct msghdr message = {0};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control_data.space;
+    message.msg_controllen = sizeof(control_data.space);
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+    uint32_t pid;
+    episode++;
+    if (sendmsg(fork_server, &message, 0) != sizeof(episode) || !read_word(&pid))
+        return -1;
+    return pid ? (pid_t)pid : -1;
+}
+
+static int start_solver(char** argv, int offer_binary, int shm_fd, int as_server) {
+    int in_pipe[2];
+    int out_pipe[2];
+    int control[2];
+    if (as_server) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, control) != 0)
+            return 0;
+        in_pipe[0] = open("/dev/null", O_RDONLY);
+        out_pipe[1] = open("/dev/null", O_WRONLY);
+    } else if (pipe(in_pipe) != 0 || pipe(out_pipe) != 0) {
+        return 0;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+        return 0;
+    if (pid == 0) {
+        dup2(in_pipe[0], STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        if (as_server) {
+            char fd[16];
+            close(control[0]);
+            snprintf(fd, sizeof(fd), "%d", control[1]);
+            setenv("MMS_FORK_SERVER", fd, 1);
+        } else {
+            close(in_pipe[1]);
+            close(out_pipe[0]);
+        }
+        if (channel) {
+            char fd[16];
+            snprintf(fd, sizeof(fd), "%d", shm_fd);
+            setenv("MMS_SHM", fd, 1);
+        }
+        if (offer_binary)
+            setenv("MMS_PROTOCOL", "binary", 1);
+        else
+            unsetenv("MMS_PROTOCOL");
+        execvp(argv[0], argv);
+        perror("headless: exec");
+        _exit(127);
+    }
+
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    if (!as_server) {
+        solver_pid = pid;
+        to_solver = in_pipe[1];
+        from_solver = out_pipe[0];
+        return 1;
+    }
+
+    uint32_t hello;
+    close(control[1]);
+    fork_server = control[0];
+    return read_word(&hello) && hello == FORK_SERVER_HELLO;
+}
+
+// Starts one episode's solver, from the fork server if there is one
+static int attach_solver(char** argv, int offer_binary, int shm_fd) {
+    if (fork_server < 0)
+        return start_solver(argv, offer_binary, shm_fd, 0);
+
+    int in_pipe[2];
+    int out_pipe[2];
+    if (pipe(in_pipe) != 0 || pipe(out_pipe) != 0)
+        return 0;
+    solver_pid = fork_solver(in_pipe[0], out_pipe[1]);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    to_solver = in_pipe[1];
+    from_solver = out_pipe[0];
+    return solver_pid > 0;
+}
+
+static long cpu_us(const struct rusage* usage) {
+    return usage->ru_utime.tv_sec * 1000000L + usage->ru_utime.tv_usec +
+           usage->ru_stime.tv_sec * 1000000L + usage->ru_stime.tv_usec;
+}
+
+// 0 once the solver has exited (and been reaped)
+static int solver_running() {
+    if (fork_server >= 0)
+        return kill(solver_pid, 0) == 0;
+    struct rusage usage;
+    if (wait4(solver_pid, &solver_status, WNOHANG, &usage) == solver_pid) {
+        solver_cpu_us = cpu_us(&usage);
+        return 0;
+    }
+    return 1;
+}
+
+// Wait status and CPU time the fork server sends once its child exits
+static void read_exit() {
+    uint32_t status;
+    uint32_t cpu;
+    if (read_word(&status) && read_word(&cpu)) {
+        solver_status = status;
+        solver_cpu_us = cpu;
+    }
+}
+
+// Waits for the solver to publish more request bytes; returns 0 if it exits
+// or stays quiet for IDLE_TIMEOUT_MS
+static int wait_for_requests(unsigned tail) {
+    for (int spin = 0; spin < spin_limit; spin++) {
+        if (atomic_load_explicit(&channel->request_head, memory_order_acquire) != tail)
+            return 1;
+    }
+
+    // Poll for exit every 10 ms while asleep
+    struct timespec slice = {0, 10000000};
+    for (int waited = 0; waited < IDLE_TIMEOUT_MS; waited += 10) {
+        atomic_store(&channel->simulator_waiting, 1);
+        if (atomic_load(&channel->request_head) != tail)
+            return 1;
+        syscall(SYS_futex, (uint32_t*)&channel->request_head, FUTEX_WAIT, tail, &slice, NULL, 0);
+        if (atomic_load(&channel->request_head) != tail)
+            return 1;
+        if (!solver_running()) {
+            solver_pid = 0;
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static void stop_solver() {
+    if (solver_pid > 0) {
+        kill(solver_pid, SIGTERM);
+        if (fork_server >= 0) {
+            read_exit();
+        } else {
+            struct rusage usage;
+            if (wait4(solver_pid, &solver_status, 0, &usage) == solver_pid)
+                solver_cpu_us = cpu_us(&usage);
+        }
+        solver_pid = 0;
+    } else if (fork_server >= 0) {
+        read_exit();  // exited on its own; the server still reports it
+    }
+    if (to_solver >= 0) {
+        close(to_solver);
+        close(from_solver);
+        to_solver = -1;
+        from_solver = -1;
+    }
+}
+
+// Next byte from the solver: -1 on exit, -2 when it has gone quiet
+static int next_byte() {
+    if (channel) {
+        unsigned tail = atomic_load_explicit(&channel->request_tail, memory_order_relaxed);
+        if (atomic_load_explicit(&channel->request_head, memory_order_acquire) == tail &&
+            !wait_for_requests(tail))
+            return solver_pid ? -2 : -1;
+        int byte = channel->ring[tail & (SHM_RING_SIZE - 1)];
+        atomic_store_explicit(&channel->request_tail, tail + 1, memory_order_release);
+        bytes_in++;
+        return byte;
+    }
+    if (pending_pos == pending_used) {
+        struct pollfd pfd = {from_solver, POLLIN, 0};
+        int ready;
+        do {
+            ready = poll(&pfd, 1, IDLE_TIMEOUT_MS);
+        } while (ready < 0 && errno == EINTR);
+        if (ready == 0)
+            return -2;
+        ssize_t n = read(from_solver, pending, sizeof(pending));
+        if (n <= 0)
+            return -1;
+        pending_used = n;
+        pending_pos = 0;
+        bytes_in += n;
+    }
+    return pending[pending_pos++];
+}
+
+static void send_reply(const void* data, int length) {
+    if (channel) {
+        unsigned seq = atomic_load_explicit(&channel->reply_seq, memory_order_relaxed);
+        channel->replies[seq % SHM_REPLY_RING] = *(const unsigned char*)data;
+        atomic_store(&channel->reply_seq, seq + 1);
+        if (atomic_load(&channel->solver_waiting)) {
+            atomic_store(&channel->solver_waiting, 0);
+            syscall(SYS_futex, (uint32_t*)&channel->reply_seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+        }
+        bytes_out += length;
+        return;
+    }
+    if (write(to_solver, data, length) == length)
+        bytes_out += length;
+}
+
+// Simulator side of every query; returns the answer as an integer
+static int answer(int op) {
+    int left = (mouse_dir + 3) % 4;
+    int right = (mouse_dir + 1) % 4;
+    queries++;
+    stall++;
+
+    if (op != PROTO_MOVE_FORWARD && op != PROTO_TURN_RIGHT && op != PROTO_TURN_LEFT)
+        motion_query();
+
+    switch (op) {
+        case PROTO_MAZE_WIDTH:
+            return width;
+        case PROTO_MAZE_HEIGHT:
+            return height;
+        case PROTO_WALL_FRONT:
+            return (maze[mouse_x][mouse_y] >> mouse_dir) & 1;
+        case PROTO_WALL_RIGHT:
+            return (maze[mouse_x][mouse_y] >> right) & 1;
+        case PROTO_WALL_LEFT:
+            return (maze[mouse_x][mouse_y] >> left) & 1;
+        case PROTO_MOVE_FORWARD:
+            stall = 0;
+            if ((maze[mouse_x][mouse_y] >> mouse_dir) & 1) {
+                motion_query();
+                crashes++;
+                return 0;
+            }
+            motion_forward();
+            mouse_x += dx[mouse_dir];
+            mouse_y += dy[mouse_dir];
+            total_moves++;
+            if (run < runs) {
+                run_moves[run]++;
+                if (run_path_length < MAX_PATH)
+                    run_path[run_path_length] = mouse_dir;
+                run_path_length++;
+                if (is_goal(mouse_x, mouse_y) && !reset_pending) {
+                    run_seconds[run] = sim.busy_until - run_started;
+                    if (run > 0 && run_path_length <= MAX_PATH)
+                        fast_seconds = motion_path_seconds(run_path, run_path_length);
+                    run++;
+                    if (run < runs)
+                        reset_pending = 1;
+                }
+            }
+            return 1;
+        case PROTO_TURN_RIGHT:
+        case PROTO_TURN_LEFT:
+            stall = 0;
+            motion_turn();
+            mouse_dir = (mouse_dir + (op == PROTO_TURN_RIGHT ? 1 : 3)) % 4;
+            if (run < runs)
+                run_turns[run]++;
+            return 1;
+        case PROTO_WAS_RESET:
+            return reset_pending;
+        case PROTO_ACK_RESET:
+            if (reset_pending) {
+                reset_pending = 0;
+                mouse_x = 0;
+                mouse_y = 0;
+                mouse_dir = 0;
+                sim.straight = 0;
+                run_started = motion_idle();
+                run_path_length = 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int is_query(int op) {
+    return (op >= PROTO_MAZE_WIDTH && op <= PROTO_TURN_LEFT) || op == PROTO_WAS_RESET ||
+           op == PROTO_ACK_RESET;
+}
+
+// Reads the rest of the request opened by 'op'; returns op, or -1 on exit
+static int read_binary_request(int op) {
+    int skip = 0;
+    switch (op) {
+        case PROTO_SET_WALL:
+        case PROTO_CLEAR_WALL:
+        case PROTO_SET_COLOR:
+            skip = 3;
+            break;
+        case PROTO_CLEAR_COLOR:
+        case PROTO_CLEAR_TEXT:
+            skip = 2;
+            break;
+        case PROTO_SET_TEXT: {
+            next_byte();
+            next_byte();
+            int length = next_byte();
+            skip = length < 0 ? 0 : length;
+            break;
+        }
+        default:
+            break;
+    }
+    for (int i = 0; i < skip; i++)
+        if (next_byte() < 0)
+            return -1;
+    return op;
+}
+
+#define HELLO_REQUEST -3  // binary offer (protocol.h), from read_text_request
+
+static const char* text_ops[] = {
+    "", "mazeWidth", "mazeHeight", "wallFront", "wallRight", "wallLeft", "moveForward",
+    "turnRight", "turnLeft", "setWall", "clearWall", "setColor", "clearColor",
+    "clearAllColor", "setText", "clearText", "clearAllText", "wasReset", "ackReset"
+};
+
+static int read_text_request(int first) {
+    char line[256];
+    int length = 0;
+    int c = first;
+    while (c != '\n') {
+        if (c < 0)
+            return c;
+        if (length < (int)sizeof(line) - 1)
+            line[length++] = (char)c;
+        c = next_byte();
+    }
+    line[length] = '\0';
+
+    char* space = strchr(line, ' ');
+    if (space)
+        *space = '\0';
+    for (int op = PROTO_MAZE_WIDTH; op <= PROTO_ACK_RESET; op++)
+        if (strcmp(line, text_ops[op]) == 0)
+            return op;
+    if (strcmp(line, PROTO_HELLO) == 0 && space && atoi(space + 1) == PROTO_VERSION)
+        return HELLO_REQUEST;
+    return 0;  // unknown commands are ignored, like mms does
+}
+
+static void reply_text(int op, int result) {
+    char text[16];
+    switch (op) {
+        case PROTO_MAZE_WIDTH:
+        case PROTO_MAZE_HEIGHT:
+            snprintf(text, sizeof(text), "%d\n", result);
+            break;
+        case PROTO_MOVE_FORWARD:
+            snprintf(text, sizeof(text), "%s\n", result ? "ack" : "crash");
+            break;
+        case PROTO_TURN_RIGHT:
+        case PROTO_TURN_LEFT:
+        case PROTO_ACK_RESET:
+            snprintf(text, sizeof(text), "ack\n");
+            break;
+        default:
+            snprintf(text, sizeof(text), "%s\n", result ? "true" : "false");
+            break;
+    }
+    send_reply(text, strlen(text));
+}
+
+// Exit code, sig<n> if killed, or ? if the status never came in
+static void describe_status(char* text, int size) {
+    if (solver_status < 0)
+        snprintf(text, size, "?");
+    else if (WIFSIGNALED(solver_status))
+        snprintf(text, size, "sig%d", WTERMSIG(solver_status));
+    else
+        snprintf(text, size, "%d", WEXITSTATUS(solver_status));
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Results store (-o): one CSV row per episode, appended, keyed by commit,
+// solver, maze corpus and parameter set (see Tools/compare.c)
+#define RESULTS_HEADER                                                                     \
+    "commit,solver,corpus,params,seed,result,goals,runs,moves,turns,queries,cpu_us,seconds," \
+    "search_s,fast_s\n"
+
+// Hash of every maze the batch will run, so results are only compared on
+// identical corpora
+static uint64_t corpus_hash(unsigned seed, long episodes, int kind) {
+    uint64_t hash = 0xcbf29ce484222325ULL;  // FNV-1a
+    for (long episode = 0; episode < episodes; episode++) {
+        generate_maze_kind(seed + episode, kind);
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                hash ^= maze[x][y];
+                hash *= 0x100000001b3ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+// Checked-out commit (with -dirty for local changes), or "unknown"
+static void current_commit(char* commit, int size) {
+    snprintf(commit, size, "unknown");
+    FILE* git = popen("git describe --always --dirty 2>/dev/null", "r");
+    if (!git)
+        return;
+    if (fgets(commit, size, git))
+        commit[strcspn(commit, "\n")] = '\0';
+    if (pclose(git) != 0 || !commit[0])
+        snprintf(commit, size, "unknown");
+}
+
+// Solver name: the algorithm argument, else the program's file name.
+// Parameters: the name=value arguments plus the harness settings that
+// change results; CSV-safe, space separated.
+static void describe_run(char** solver_argv, int offer_binary, int use_shm, int as_server,
+                         const char* model, char* solver, int solver_size, char* params,
+                         int params_size) {
+    const char* program = strrchr(solver_argv[0], '/');
+    program = program ? program + 1 : solver_argv[0];
+    int next = 1;
+    if (solver_argv[1] && !strchr(solver_argv[1], '='))
+        program = solver_argv[next++];
+    snprintf(solver, solver_size, "%s", program);
+
+    int used = snprintf(params, params_size, "runs=%d size=%dx%d protocol=%s%s", runs, width,
+                        height, use_shm ? "shm" : offer_binary ? "binary" : "text",
+                        as_server ? " fork=1" : "");
+    if (model && used < params_size)
+        used += snprintf(params + used, params_size - used, " model=%s", model);
+    for (int i = next; solver_argv[i] && used < params_size; i++)
+        used += snprintf(params + used, params_size - used, " %s", solver_argv[i]);
+    for (char* c = params; *c; c++) {
+        if (*c == ',' || *c == '"' || *c == '\n')
+            *c = ';';
+    }
+}
+
+static void append_result(FILE* results, const char* commit, const char* solver,
+                          uint64_t corpus, const char* params, unsigned episode_seed,
+                          const char* outcome, double elapsed) {
+    int moves = 0;
+    int turns = 0;
+    for (int i = 0; i < runs; i++) {
+        moves += run_moves[i];
+        turns += run_turns[i];
+    }
+    fprintf(results, "%s,%s,%016llx,%s,%u,%s,%d,%d,%d,%d,%ld,%ld,%.6f,%.4f,%.4f\n", commit,
+            solver, (unsigned long long)corpus, params, episode_seed, outcome, run, runs, moves,
+            turns, queries, solver_cpu_us, elapsed, run > 0 ? run_seconds[0] : -1,
+            fast_seconds);
+    fflush(results);
+}
+
+// Runs one episode on the current maze; returns its outcome
+static const char* run_episode(int offer_binary, long move_budget, long query_budget,
+                               int* binary) {
+    *binary = channel != NULL;
+    int switching = 0;      // binary accepted, from the next reply on
+    double replied_at = 0;  // real time, for solver think time (motion.cpu)
+
+    while (run < runs) {
+        int first = next_byte();
+        int op;
+
+        if (first < 0)
+            op = first;
+        else if (*binary)
+            op = read_binary_request(first);
+        else
+            op = read_text_request(first);
+
+        if (op == -1)
+            return "exited";
+        if (op == -2)
+            return "idle";
+        if (op == HELLO_REQUEST) {
+            // Accept, unless -t: then ignore it as mms would
+            if (offer_binary) {
+                char text[32];
+                snprintf(text, sizeof(text), "%s %d\n", PROTO_HELLO, PROTO_VERSION);
+                send_reply(text, strlen(text));
+                switching = 1;
+            }
+            continue;
+        }
+        if (!is_query(op)) {
+            display_commands++;
+            continue;
+        }
+
+        if (motion.cpu > 0 && replied_at > 0)
+            motion_think(now_seconds() - replied_at);
+        int result = answer(op);
+        if (*binary) {
+            unsigned char byte = (unsigned char)result;
+            send_reply(&byte, 1);
+        } else {
+            reply_text(op, result);
+            // The handshake's last text reply; frames from here on
+            *binary = switching;
+        }
+        if (motion.cpu > 0)
+            replied_at = now_seconds();
+
+        if (total_moves > move_budget)
+            return "move-budget";
+        if (queries > query_budget)
+            return "query-budget";
+        if (stall > STALL_QUERIES)
+            return "stalled";
+    }
+    return "goal";
+}
+
+int main(int argc, char* argv[]) {
+    unsigned seed = 1;
+    long episodes = 1;
+    int kind = MAZE_LOOPS;
+    const char* model = NULL;
+    int model_ok = 1;
+    long move_budget = 100000;
+    long query_budget = 1000000;
+    int offer_binary = 1;
+    int use_shm = 0;
+    int as_server = 0;
+    const char* results_path = NULL;
+    const char* commit_label = NULL;
+
+    int arg = 1;
+    while (arg < argc && argv[arg][0] == '-') {
+        const char* flag = argv[arg];
+        if (strcmp(flag, "-t") == 0 || strcmp(flag, "-x") == 0 || strcmp(flag, "-f") == 0) {
+            offer_binary &= flag[1] != 't';
+            use_shm |= flag[1] == 'x';
+            as_server |= flag[1] == 'f';
+            arg++;
+            continue;
+        }
+        if (arg + 1 >= argc)
+            break;
+        long value = atol(argv[arg + 1]);
+        if (strcmp(flag, "-o") == 0)
+            results_path = argv[arg + 1];
+        else if (strcmp(flag, "-c") == 0)
+            commit_label = argv[arg + 1];
+        else if (strcmp(flag, "-k") == 0)
+            kind = maze_kind(argv[arg + 1]);
+        else if (strcmp(flag, "-p") == 0) {
+            model = argv[arg + 1];
+            model_ok = motion_configure(model);
+        } else if (strcmp(flag, "-w") == 0)
+            width = value;
+        else if (strcmp(flag, "-h") == 0)
+            height = value;
+        else if (strcmp(flag, "-s") == 0)
+            seed = value;
+        else if (strcmp(flag, "-r") == 0)
+            runs = value;
+        else if (strcmp(flag, "-e") == 0)
+            episodes = value;
+        else if (strcmp(flag, "-m") == 0)
+            move_budget = value;
+        else if (strcmp(flag, "-q") == 0)
+            query_budget = value;
+        else
+            break;
+        arg += 2;
+    }
+    if (arg >= argc || width < 1 || width > MAX_MAZE || height < 1 || height > MAX_MAZE ||
+        runs < 1 || runs > 64 || episodes < 1 || kind == MAZE_KINDS || !model_ok) {
+        fprintf(stderr, "usage: headless [-w n] [-h n] [-s seed] [-k kind] [-r runs] [-e episodes] "
+                        "[-m moves] [-q queries] [-t] [-x] [-f] [-o results.csv] [-c commit] "
+                        "[-p name=value,...] <solver> [args...]\n");
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int shm_fd = use_shm ? create_channel() : -1;
+    if (use_shm && shm_fd < 0) {
+        fprintf(stderr, "headless: cannot create the shared-memory channel\n");
+        return 2;
+    }
+    if (as_server && !start_solver(&argv[arg], offer_binary, shm_fd, 1)) {
+        fprintf(stderr, "headless: %s did not start as a fork server\n", argv[arg]);
+        return 2;
+    }
+
+    FILE* results = NULL;
+    char commit[64];
+    char solver[64];
+    char params[512];
+    uint64_t corpus = 0;
+    if (results_path) {
+        results = fopen(results_path, "a+");
+        if (!results) {
+            perror("headless: results");
+            return 2;
+        }
+        fseek(results, 0, SEEK_END);
+        if (ftell(results) == 0) {
+            fputs(RESULTS_HEADER, results);
+        } else {
+            char header[256];
+            rewind(results);
+            if (!fgets(header, sizeof(header), results) || strcmp(header, RESULTS_HEADER) != 0) {
+                fprintf(stderr, "headless: %s has other columns; start a new results file\n",
+                        results_path);
+                return 2;
+            }
+        }
+        if (commit_label)
+            snprintf(commit, sizeof(commit), "%s", commit_label);
+        else
+            current_commit(commit, sizeof(commit));
+        describe_run(&argv[arg], offer_binary, use_shm, as_server, model, solver,
+                     sizeof(solver), params, sizeof(params));
+        corpus = corpus_hash(seed, episodes, kind);
+    }
+
+    double batch_started = now_seconds();
+    long goals = 0;
+    double search_total = 0;
+    long searches = 0;
+    double fast_total = 0;
+    long fast_runs = 0;
+    for (long episode = 0; episode < episodes; episode++) {
+        unsigned episode_seed = seed + episode;
+        reset_episode();
+        motion_reset(episode_seed);
+        generate_maze_kind(episode_seed, kind);
+        unlink(SAVED_MAZE);
+        double started = now_seconds();
+        if (!attach_solver(&argv[arg], offer_binary, shm_fd)) {
+            fprintf(stderr, "headless: cannot start %s\n", argv[arg]);
+            return 2;
+        }
+
+        int binary;
+        const char* outcome = run_episode(offer_binary, move_budget, query_budget, &binary);
+        double elapsed = now_seconds() - started;
+        stop_solver();
+        goals += run == runs;
+        if (run > 0) {
+            search_total += run_seconds[0];
+            searches++;
+        }
+        if (fast_seconds >= 0) {
+            fast_total += fast_seconds;
+            fast_runs++;
+        }
+
+        char status[16];
+        describe_status(status, sizeof(status));
+        printf("result=%s protocol=%s maze=%dx%d kind=%s seed=%u runs=%d/%d moves=", outcome,
+               channel ? "shm" : binary ? "binary" : "text", width, height,
+               maze_kind_names[kind], episode_seed, run, runs);
+        for (int i = 0; i < runs; i++)
+            printf("%s%d", i ? "," : "", run_moves[i]);
+        printf(" turns=");
+        for (int i = 0; i < runs; i++)
+            printf("%s%d", i ? "," : "", run_turns[i]);
+        printf(" sim_s=");
+        for (int i = 0; i < runs; i++) {
+            if (i < run)
+                printf("%s%.3f", i ? "," : "", run_seconds[i]);
+            else
+                printf("%s-", i ? "," : "");
+        }
+        if (fast_seconds >= 0)
+            printf(" fast_s=%.3f", fast_seconds);
+        else
+            printf(" fast_s=-");
+        printf(" crashes=%d queries=%ld display=%ld bytes_in=%ld bytes_out=%ld exit=%s "
+               "cpu_us=%ld seconds=%.4f\n",
+               crashes, queries, display_commands, bytes_in, bytes_out, status, solver_cpu_us,
+               elapsed);
+        if (results)
+            append_result(results, commit, solver, corpus, params, episode_seed, outcome, elapsed);
+    }
+
+    if (episodes > 1) {
+        double elapsed = now_seconds() - batch_started;
+        printf("episodes=%ld goals=%ld seconds=%.4f episodes_per_second=%.1f", episodes, goals,
+               elapsed, episodes / elapsed);
+        // Means over the episodes that got that far
+        if (searches)
+            printf(" search_s=%.3f", search_total / searches);
+        if (fast_runs)
+            printf(" fast_s=%.3f", fast_total / fast_runs);
+        printf("\n");
+    }
+    if (results)
+        fclose(results);
+    return goals == episodes ? 0 : 1;
+}
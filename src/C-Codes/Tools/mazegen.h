@@ -0,0 +1,211 @@
+#pragma once
+
+// Random test mazes shared by the host tools (header only; tools build from
+// a single .c file). A depth-first carved maze with about 1 in 8 of the
+// remaining inner walls knocked out, so wall followers can loop, and an
+// open 2x2 goal room in the center. The same seed always gives the same maze.
+// generate_maze_kind() reshapes the goal area of that maze for stress runs.
+
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_MAZE 255
+
+// Direction vectors: 0=N, 1=E, 2=S, 3=W
+static const int dx[] = {0, 1, 0, -1};
+static const int dy[] = {1, 0, -1, 0};
+
+// Maze: bit d set if cell (x, y) has a wall on side d
+static unsigned char maze[MAX_MAZE][MAX_MAZE];
+static int width = 16;
+static int height = 16;
+
+static uint64_t rng_state = 1;
+
+static inline uint32_t next_random() {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+static inline int in_maze(int x, int y) {
+    return x >= 0 && x < width && y >= 0 && y < height;
+}
+
+static inline void set_wall(int x, int y, int d, int wall) {
+    int nx = x + dx[d];
+    int ny = y + dy[d];
+    if (wall)
+        maze[x][y] |= 1 << d;
+    else
+        maze[x][y] &= ~(1 << d);
+    if (in_maze(nx, ny)) {
+        int opposite = (d + 2) % 4;
+        if (wall)
+            maze[nx][ny] |= 1 << opposite;
+        else
+            maze[nx][ny] &= ~(1 << opposite);
+    }
+}
+
+static inline int is_goal(int x, int y) {
+    int cx = width / 2;
+    int cy = height / 2;
+    return (x == cx - 1 || x == cx) && (y == cy - 1 || y == cy);
+}
+
+static inline void generate_maze(unsigned seed) {
+    static int stack_x[MAX_MAZE * MAX_MAZE];
+    static int stack_y[MAX_MAZE * MAX_MAZE];
+    static unsigned char seen[MAX_MAZE][MAX_MAZE];
+
+    rng_state = seed * 2654435761ULL + 1;
+    memset(seen, 0, sizeof(seen));
+    for (int x = 0; x < width; x++)
+        for (int y = 0; y < height; y++)
+            maze[x][y] = 0x0F;
+
+    int top = 0;
+    stack_x[0] = 0;
+    stack_y[0] = 0;
+    seen[0][0] = 1;
+    while (top >= 0) {
+        int x = stack_x[top];
+        int y = stack_y[top];
+        int options[4];
+        int count = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d];
+            int ny = y + dy[d];
+            if (in_maze(nx, ny) && !seen[nx][ny])
+                options[count++] = d;
+        }
+        if (count == 0) {
+            top--;
+            continue;
+        }
+        int d = options[next_random() % count];
+        set_wall(x, y, d, 0);
+        seen[x + dx[d]][y + dy[d]] = 1;
+        top++;
+        stack_x[top] = x + dx[d];
+        stack_y[top] = y + dy[d];
+    }
+
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            for (int d = 0; d < 2; d++) {  // N and E cover every inner wall once
+                if (in_maze(x + dx[d], y + dy[d]) && (maze[x][y] & (1 << d)) &&
+                    next_random() % 8 == 0)
+                    set_wall(x, y, d, 0);
+            }
+        }
+    }
+
+    if (width >= 2 && height >= 2) {
+        int cx = width / 2;
+        int cy = height / 2;
+        set_wall(cx - 1, cy - 1, 0, 0);
+        set_wall(cx - 1, cy - 1, 1, 0);
+        set_wall(cx, cy, 2, 0);
+        set_wall(cx, cy, 3, 0);
+    }
+}
+
+// MAZE_LOOPS is generate_maze() as is; the others rework its centre:
+//   island         the goal room is closed but for one gap and stands in an
+//                  open ring, so its walls touch no others and a wall
+//                  follower never gets there
+//   blocked-goal   the goal room is walled off
+//   walled-center  a closed ring of walls around the centre 4x4 block
+// The last two leave the goal unreachable unless the start is inside.
+typedef enum {MAZE_LOOPS, MAZE_ISLAND, MAZE_BLOCKED_GOAL, MAZE_WALLED_CENTER, MAZE_KINDS} MazeKind;
+
+static const char* maze_kind_names[MAZE_KINDS] = {
+    "loops", "island", "blocked-goal", "walled-center"
+};
+
+// MAZE_KINDS if the name is unknown
+static inline int maze_kind(const char* name) {
+    int kind = 0;
+    while (kind < MAZE_KINDS && strcmp(name, maze_kind_names[kind]) != 0)
+        kind++;
+    return kind;
+}
+
+// Sets every wall between the block and the rest of the maze
+static inline void close_block(int x0, int y0, int x1, int y1) {
+    for (int x = x0; x <= x1; x++) {
+        for (int y = y0; y <= y1; y++) {
+            for (int d = 0; d < 4; d++) {
+                int nx = x + dx[d];
+                int ny = y + dy[d];
+                if (nx < x0 || nx > x1 || ny < y0 || ny > y1)
+                    set_wall(x, y, d, 1);
+            }
+        }
+    }
+}
+
+static inline void generate_maze_kind(unsigned seed, int kind) {
+    generate_maze(seed);
+    if (kind == MAZE_LOOPS || width < 4 || height < 4)
+        return;
+
+    int cx = width / 2;
+    int cy = height / 2;
+    switch (kind) {
+        case MAZE_ISLAND: {
+            for (int x = cx - 2; x <= cx + 1; x++)
+                for (int y = cy - 2; y <= cy + 1; y++)
+                    for (int d = 0; d < 4; d++)
+                        if (in_maze(x + dx[d], y + dy[d]))
+                            set_wall(x, y, d, 0);
+            close_block(cx - 1, cy - 1, cx, cy);
+            // One of the room's eight outer sides stays open
+            int gap = next_random() % 8;
+            int d = gap / 2;
+            int x = (d == 1) ? cx : (d == 3) ? cx - 1 : cx - 1 + gap % 2;
+            int y = (d == 0) ? cy : (d == 2) ? cy - 1 : cy - 1 + gap % 2;
+            set_wall(x, y, d, 0);
+            break;
+        }
+        case MAZE_BLOCKED_GOAL:
+            close_block(cx - 1, cy - 1, cx, cy);
+            break;
+        case MAZE_WALLED_CENTER:
+            close_block(cx - 2, cy - 2, cx + 1, cy + 1);
+            break;
+    }
+}
+
+// 1 if some goal cell can be reached from (0, 0)
+static inline int goal_reachable() {
+    static int queue_x[MAX_MAZE * MAX_MAZE];
+    static int queue_y[MAX_MAZE * MAX_MAZE];
+    static unsigned char seen[MAX_MAZE][MAX_MAZE];
+
+    memset(seen, 0, sizeof(seen));
+    int head = 0;
+    int tail = 1;
+    queue_x[0] = 0;
+    queue_y[0] = 0;
+    seen[0][0] = 1;
+    while (head < tail) {
+        int x = queue_x[head];
+        int y = queue_y[head];
+        head++;
+        if (is_goal(x, y))
+            return 1;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d];
+            int ny = y + dy[d];
+            if (in_maze(nx, ny) && !(maze[x][y] & (1 << d)) && !seen[nx][ny]) {
+                seen[nx][ny] = 1;
+                queue_x[tail] = nx;
+                queue_y[tail] = ny;
+                tail++;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+// Simulated competition time for headless (header only, like mazegen.h)
+//
+// Every request the solver makes is charged on a simulated clock:
+//   - a query (walls, maze size, reset) is a round trip of 'sensor' seconds,
+//     and waits for the motion in progress to end, since a reading belongs
+//     to the cell the mouse is moving into;
+//   - a motion command costs the solver 'command' seconds to hand over and
+//     then runs in the background, after any motion still in progress.
+//     Consecutive forward moves form one straight that accelerates at
+//     'accel' up to 'speed' and brakes to rest at its end (trapezoidal
+//     profile); the k-th cell is charged T(k cells) - T(k-1 cells). Turns
+//     happen in place, 'turn' seconds per 90 degrees.
+//   - with cpu > 0, the solver's real think time between a reply and its next
+//     request counts as cpu simulated seconds per real second. Motion goes
+//     on meanwhile, so planning between a move and the next query (as
+//     speculate=1 and MMS_PIPELINE do) is hidden by the move and planning
+//     after the query is not.
+// Each latency varies uniformly by +-jitter, from a generator seeded per
+// episode so runs repeat exactly.
+//
+// motion_path_seconds() estimates a fast run over a path the mouse has
+// driven, from kinematics alone: no sensing, straights as above, and
+// staircases of single cells (N, E, N, E...) cut as diagonals at 'diag'.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    double cell;     // cell length, m
+    double accel;    // m/s^2, for speeding up and braking
+    double speed;    // top speed on straights, m/s
+    double diag;     // top speed on diagonals, m/s
+    double turn;     // in-place 90 degree turn, s
+    double sensor;   // query round trip, s
+    double command;  // motion command hand-over, s
+    double jitter;   // latency spread, +-s
+    double cpu;      // simulated s per real s of solver think time
+} MotionModel;
+
+static MotionModel motion = {0.18, 2.0, 1.0, 0.7, 0.25, 0.002, 0.002, 0, 0};
+
+static const char* motion_names[] = {
+    "cell", "accel", "speed", "diag", "turn", "sensor", "command", "jitter", "cpu"
+};
+static double* const motion_values[] = {
+    &motion.cell, &motion.accel, &motion.speed, &motion.diag, &motion.turn,
+    &motion.sensor, &motion.command, &motion.jitter, &motion.cpu
+};
+#define MOTION_PARAMS (int)(sizeof(motion_names) / sizeof(motion_names[0]))
+
+static struct {
+    double now;         // where the solver is
+    double busy_until;  // end of the motion in progress
+    int straight;       // cells so far in the current straight
+    uint64_t rng;
+} sim;
+
+// Applies "name=value,name=value..."; returns 0 on an unknown name, a
+// negative value, or a zero length, acceleration or speed
+static inline int motion_configure(const char* spec) {
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", spec);
+    for (char* item = strtok(copy, ","); item; item = strtok(NULL, ",")) {
+        char* equals = strchr(item, '=');
+        if (!equals)
+            return 0;
+        *equals = '\0';
+        int i = 0;
+        while (i < MOTION_PARAMS && strcmp(item, motion_names[i]) != 0)
+            i++;
+        double value = atof(equals + 1);
+        if (i == MOTION_PARAMS || value < 0)
+            return 0;
+        *motion_values[i] = value;
+    }
+    return motion.cell > 0 && motion.accel > 0 && motion.speed > 0 && motion.diag > 0;
+}
+
+static inline void motion_reset(unsigned seed) {
+    memset(&sim, 0, sizeof(sim));
+    sim.rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+static inline double motion_latency(double base) {
+    if (motion.jitter <= 0)
+        return base;
+    sim.rng = sim.rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    double unit = (sim.rng >> 11) * (1.0 / 9007199254740992.0);  // [0, 1)
+    double latency = base + (2 * unit - 1) * motion.jitter;
+    return latency > 0 ? latency : 0;
+}
+
+// Rest-to-rest time over 'distance' metres at top speed v
+static inline double motion_straight(double distance, double v) {
+    double ramp = v * v / motion.accel;  // speeding up plus braking
+    if (distance >= ramp)
+        return distance / v + v / motion.accel;
+    return 2 * sqrt(distance / motion.accel);
+}
+
+static inline double motion_idle() {
+    return sim.now > sim.busy_until ? sim.now : sim.busy_until;
+}
+
+static inline void motion_think(double real_seconds) {
+    sim.now += real_seconds * motion.cpu;
+}
+
+static inline void motion_query() {
+    sim.now = motion_idle() + motion_latency(motion.sensor);
+}
+
+static inline void motion_start(double duration) {
+    sim.now += motion_latency(motion.command);
+    sim.busy_until = motion_idle() + duration;
+}
+
+static inline void motion_forward() {
+    sim.straight++;
+    motion_start(motion_straight(sim.straight * motion.cell, motion.speed) -
+                 motion_straight((sim.straight - 1) * motion.cell, motion.speed));
+}
+
+static inline void motion_turn() {
+    sim.straight = 0;
+    motion_start(motion.turn);
+}
+
+// Turning between two of the eight 45 degree headings
+static inline double motion_turn_between(int from, int to) {
+    int steps = (to - from + 8) % 8;
+    if (steps > 4)
+        steps = 8 - steps;
+    return motion.turn * steps / 2;
+}
+
+// Fast-run estimate over the headings (0=N .. 3=W) of a driven path,
+// starting at rest facing north
+static inline double motion_path_seconds(const unsigned char* headings, int count) {
+    double seconds = 0;
+    int facing = 0;  // in 45 degree steps
+    int i = 0;
+    while (i < count) {
+        // Staircase: alternating perpendicular single cells
+        int length = 1;
+        while (i + length < count && (headings[i + length] - headings[i + length - 1] + 4) % 2 &&
+               (length < 2 || headings[i + length] == headings[i + length - 2]))
+            length++;
+        if (length >= 3) {
+            int a = headings[i] * 2;
+            int b = headings[i + 1] * 2;
+            int diagonal = ((b - a + 8) % 8 == 2) ? (a + 1) % 8 : (a + 7) % 8;
+            seconds += motion_turn_between(facing, diagonal) +
+                       motion_straight(length * motion.cell / sqrt(2), motion.diag);
+            facing = diagonal;
+            i += length;
+            continue;
+        }
+
+        length = 1;
+        while (i + length < count && headings[i + length] == headings[i])
+            length++;
+        seconds += motion_turn_between(facing, headings[i] * 2) +
+                   motion_straight(length * motion.cell, motion.speed);
+        facing = headings[i] * 2;
+        i += length;
+    }
+    return seconds;
+}
@@ -0,0 +1,227 @@
+// render.c - Turn an MMS_CAPTURE frame file into images
+//
+// Usage: render [-s cell_px] [-e every] <capture> <out_prefix>
+//
+// Writes <out_prefix>_00000.ppm, _00001.ppm, ... (one image per captured
+// frame, or every n-th with -e). Cells are shaded by distance to the goal,
+// sensed walls are black, unsensed edges are a faint grid and the mouse is a
+// red square with a tick toward its heading. To make an animation:
+//   ffmpeg -i out_%05d.ppm maze.gif
+//
+// Build: gcc -O2 render.c -o render
+#include "../Common/capture.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    unsigned char r, g, b;
+} Color;
+
+static const Color BACKGROUND = {40, 40, 40};    // never sensed
+static const Color NO_DISTANCE = {150, 150, 150};
+static const Color GRID = {90, 90, 90};
+static const Color WALL = {0, 0, 0};
+static const Color MOUSE = {220, 30, 30};
+static const Color TICK = {255, 255, 255};
+
+static int cell_px = 24;
+static int width = 0;
+static int height = 0;
+static int image_w = 0;
+static int image_h = 0;
+static unsigned char* image = NULL;
+
+static unsigned get_u16(const unsigned char* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint32_t get_varint(const unsigned char* data, size_t size, size_t* pos) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*pos < size) {
+        unsigned char b = data[(*pos)++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+        shift += 7;
+    }
+    return value;
+}
+
+static void fill(int x0, int y0, int w, int h, Color c) {
+    for (int y = y0; y < y0 + h; y++) {
+        if (y < 0 || y >= image_h)
+            continue;
+        for (int x = x0; x < x0 + w; x++) {
+            if (x < 0 || x >= image_w)
+                continue;
+            unsigned char* p = &image[(y * image_w + x) * 3];
+            p[0] = c.r;
+            p[1] = c.g;
+            p[2] = c.b;
+        }
+    }
+}
+
+// Near the goal is yellow, far is blue
+static Color heat(unsigned distance, unsigned max_distance) {
+    double t = max_distance ? (double)distance / max_distance : 0;
+    Color c = {(unsigned char)(230 * (1 - t) + 30 * t), (unsigned char)(200 * (1 - t) + 60 * t),
+               (unsigned char)(40 * (1 - t) + 200 * t)};
+    return c;
+}
+
+static void render(const CaptureCell* cells, int mx, int my, int heading) {
+    unsigned max_distance = 0;
+    for (int i = 0; i < width * height; i++) {
+        unsigned d = cells[i].distance_lo | (cells[i].distance_hi << 8);
+        if (d != CAPTURE_UNKNOWN && d > max_distance)
+            max_distance = d;
+    }
+
+    fill(0, 0, image_w, image_h, BACKGROUND);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const CaptureCell* cell = &cells[y * width + x];
+            int px = x * cell_px;
+            int py = (height - 1 - y) * cell_px;  // maze y grows upward
+            unsigned d = cell->distance_lo | (cell->distance_hi << 8);
+
+            if (d != CAPTURE_UNKNOWN)
+                fill(px, py, cell_px, cell_px, heat(d, max_distance));
+            else if (cell->known)
+                fill(px, py, cell_px, cell_px, NO_DISTANCE);
+
+            // Edges: N, E, S, W
+            int thick = cell_px / 8 > 1 ? cell_px / 8 : 1;
+            int edge_x[4] = {px, px + cell_px - thick, px, px};
+            int edge_y[4] = {py, py, py + cell_px - thick, py};
+            int edge_w[4] = {cell_px, thick, cell_px, thick};
+            int edge_h[4] = {thick, cell_px, thick, cell_px};
+            for (int s = 0; s < 4; s++) {
+                if (cell->walls & (1 << s))
+                    fill(edge_x[s], edge_y[s], edge_w[s], edge_h[s], WALL);
+                else if (!(cell->known & (1 << s)))
+                    fill(edge_x[s], edge_y[s], s & 1 ? 1 : edge_w[s], s & 1 ? edge_h[s] : 1, GRID);
+            }
+        }
+    }
+
+    if (mx >= 0 && mx < width && my >= 0 && my < height) {
+        int cx = mx * cell_px + cell_px / 2;
+        int cy = (height - 1 - my) * cell_px + cell_px / 2;
+        int r = cell_px / 4;
+        fill(cx - r, cy - r, 2 * r, 2 * r, MOUSE);
+        static const int tx[] = {0, 1, 0, -1};
+        static const int ty[] = {-1, 0, 1, 0};
+        fill(cx + tx[heading & 3] * r - 1, cy + ty[heading & 3] * r - 1, 3, 3, TICK);
+    }
+}
+
+static int write_ppm(const char* prefix, int index) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s_%05d.ppm", prefix, index);
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return 0;
+    fprintf(file, "P6\n%d %d\n255\n", image_w, image_h);
+    fwrite(image, 1, (size_t)image_w * image_h * 3, file);
+    fclose(file);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    int every = 1;
+    int arg = 1;
+    while (arg + 1 < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-s") == 0)
+            cell_px = atoi(argv[arg + 1]);
+        else if (strcmp(argv[arg], "-e") == 0)
+            every = atoi(argv[arg + 1]);
+        else
+            break;
+        arg += 2;
+    }
+    if (argc - arg != 2 || cell_px < 4 || every < 1) {
+        fprintf(stderr, "usage: render [-s cell_px] [-e every] <capture> <out_prefix>\n");
+        return 2;
+    }
+
+    int fd = open(argv[arg], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < 9) {
+        fprintf(stderr, "render: cannot read %s\n", argv[arg]);
+        return 2;
+    }
+    size_t size = st.st_size;
+    const unsigned char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || memcmp(data, "MMCF", 4) != 0 || data[4] != CAPTURE_VERSION) {
+        fprintf(stderr, "render: %s is not a capture file\n", argv[arg]);
+        return 2;
+    }
+
+    width = get_u16(data + 5);
+    height = get_u16(data + 7);
+    size_t bytes = (size_t)width * height * sizeof(CaptureCell);
+    unsigned char* cells = calloc(1, bytes);
+    image_w = width * cell_px;
+    image_h = height * cell_px;
+    image = malloc((size_t)image_w * image_h * 3);
+    if (!cells || !image)
+        return 2;
+
+    size_t pos = 9;
+    int frames = 0;
+    int written = 0;
+    uint32_t last_step = 0;
+    while (pos + 14 <= size) {
+        const unsigned char* header = data + pos;
+        uint32_t step = get_u32(header);
+        int mx = get_u16(header + 4);
+        int my = get_u16(header + 6);
+        int heading = header[8];
+        int key = header[9] & 1;
+        uint32_t payload_size = get_u32(header + 10);
+        if (pos + 14 + payload_size > size)
+            break;  // truncated last frame
+
+        // Undo the zero-run coding and the XOR against the previous frame
+        const unsigned char* payload = header + 14;
+        size_t p = 0;
+        size_t i = 0;
+        if (key)
+            memset(cells, 0, bytes);
+        while (p < payload_size && i < bytes) {
+            i += get_varint(payload, payload_size, &p);
+            uint32_t literals = get_varint(payload, payload_size, &p);
+            for (uint32_t j = 0; j < literals && i < bytes && p < payload_size; j++)
+                cells[i++] ^= payload[p++];
+        }
+        pos += 14 + payload_size;
+
+        if (frames % every == 0) {
+            render((const CaptureCell*)cells, mx, my, heading);
+            if (!write_ppm(argv[arg + 1], written)) {
+                fprintf(stderr, "render: cannot write images to %s\n", argv[arg + 1]);
+                return 1;
+            }
+            written++;
+        }
+        frames++;
+        last_step = step;
+    }
+
+    printf("%d frames (%dx%d maze, last step %u, %.1f bytes/frame), %d images written\n",
+           frames, width, height, last_step, frames ? (double)(size - 9) / frames : 0.0, written);
+    return 0;
+}
@@ -0,0 +1,375 @@
+// replay.c - Run a solver binary against a recorded API trace
+//
+// Usage: replay [-v] <trace> <solver> [solver args...]
+//
+// The solver is started with pipes in place of the simulator. Every query it
+// sends is answered from the trace and every command is checked against the
+// recording; the first mismatch is reported and the replay stops. Answers are
+// immediate, so the run measures the solver's own compute at full speed (run
+// the solver under a profiler to split it further). The solver runs in a
+// private temporary directory, so a maze.bin left by another run cannot
+// steer it away from the recording, and with the plain text protocol.
+//
+// Build: gcc -O2 replay.c -o replay
+#include "../Common/trace.h"
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LINE_SIZE 256
+#define REPLY_TIMEOUT_MS 2000
+
+typedef struct {
+    int op;
+    int result;
+    int x, y;
+    char arg;
+    uint32_t delta;
+    uint32_t duration;
+    char text[128];
+} Record;
+
+static const char* op_names[] = {
+    "", "mazeWidth", "mazeHeight", "wallFront", "wallRight", "wallLeft",
+    "moveForward", "turnRight", "turnLeft", "setWall", "clearWall", "setColor",
+    "clearColor", "clearAllColor", "setText", "clearText", "clearAllText",
+    "wasReset", "ackReset", "debug_log", "gap"
+};
+
+static Record* records = NULL;
+static int record_count = 0;
+
+static int verbose = 0;
+static int to_solver = -1;
+static int from_solver = -1;
+static pid_t solver_pid = 0;
+static char directory[] = "/tmp/mms-replay-XXXXXX";
+
+// Line reader over the solver's stdout with a timeout
+static char pending[4096];
+static int pending_used = 0;
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t get_varint(const unsigned char* data, long size, long* pos) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*pos < size) {
+        unsigned char b = data[(*pos)++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+        shift += 7;
+    }
+    return value;
+}
+
+static int get_zigzag(const unsigned char* data, long size, long* pos) {
+    uint32_t u = get_varint(data, size, pos);
+    return (int)(u >> 1) ^ -(int)(u & 1);
+}
+
+static int load_trace(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = malloc(size);
+    if (!data || fread(data, 1, size, file) != (size_t)size) {
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+
+    if (size < 5 || memcmp(data, "MMTR", 4) != 0 || data[4] != TRACE_VERSION) {
+        free(data);
+        return 0;
+    }
+
+    // Every record is at least two bytes
+    records = calloc(size / 2 + 1, sizeof(Record));
+    long pos = 5;
+    int last_x = 0;
+    int last_y = 0;
+
+    while (pos < size) {
+        Record* r = &records[record_count++];
+        unsigned char op_byte = data[pos++];
+        r->op = op_byte & ~TRACE_RESULT_BIT;
+        r->result = (op_byte & TRACE_RESULT_BIT) != 0;
+        r->delta = get_varint(data, size, &pos);
+
+        if (r->op <= TRACE_TURN_LEFT || r->op == TRACE_WAS_RESET || r->op == TRACE_ACK_RESET)
+            r->duration = get_varint(data, size, &pos);
+
+        switch (r->op) {
+            case TRACE_MAZE_WIDTH:
+            case TRACE_MAZE_HEIGHT:
+            case TRACE_GAP:
+                r->result = (int)get_varint(data, size, &pos);
+                break;
+            case TRACE_SET_WALL:
+            case TRACE_CLEAR_WALL:
+            case TRACE_SET_COLOR:
+            case TRACE_CLEAR_COLOR:
+            case TRACE_SET_TEXT:
+            case TRACE_CLEAR_TEXT:
+                last_x += get_zigzag(data, size, &pos);
+                last_y += get_zigzag(data, size, &pos);
+                r->x = last_x;
+                r->y = last_y;
+                if (r->op == TRACE_SET_WALL || r->op == TRACE_CLEAR_WALL || r->op == TRACE_SET_COLOR)
+                    r->arg = (char)data[pos++];
+                break;
+            default:
+                break;
+        }
+
+        if (r->op == TRACE_SET_TEXT || r->op == TRACE_DEBUG_LOG) {
+            uint32_t length = get_varint(data, size, &pos);
+            uint32_t kept = length < sizeof(r->text) ? length : sizeof(r->text) - 1;
+            memcpy(r->text, &data[pos], kept);
+            r->text[kept] = '\0';
+            pos += length;
+        }
+
+        if (r->op < TRACE_MAZE_WIDTH || r->op > TRACE_GAP) {
+            fprintf(stderr, "replay: corrupt record %d\n", record_count - 1);
+            free(data);
+            return 0;
+        }
+        if (r->op == TRACE_GAP) {
+            fprintf(stderr, "replay: %d calls missing before record %d, the trace "
+                            "cannot be replayed\n", r->result, record_count - 1);
+            free(data);
+            return 0;
+        }
+    }
+    free(data);
+    return 1;
+}
+
+static int start_solver(char** argv) {
+    int in_pipe[2];
+    int out_pipe[2];
+    if (pipe(in_pipe) != 0 || pipe(out_pipe) != 0)
+        return 0;
+    if (!mkdtemp(directory))
+        return 0;
+
+    solver_pid = fork();
+    if (solver_pid < 0)
+        return 0;
+    if (solver_pid == 0) {
+        dup2(in_pipe[0], STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        unsetenv("MMS_TRACE");  // do not overwrite the trace being replayed
+        unsetenv("MMS_PROTOCOL");
+        unsetenv("MMS_SHM");
+        unsetenv("MMS_PIPELINE");
+        // A solver path relative to here must survive the chdir
+        char path[PATH_MAX];
+        if (strchr(argv[0], '/') && realpath(argv[0], path))
+            argv[0] = path;
+        if (chdir(directory) != 0) {
+            perror("replay: temporary directory");
+            _exit(127);
+        }
+        execvp(argv[0], argv);
+        perror("replay: exec");
+        _exit(127);
+    }
+
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    to_solver = in_pipe[1];
+    from_solver = out_pipe[0];
+    return 1;
+}
+
+static void stop_solver() {
+    if (solver_pid > 0) {
+        kill(solver_pid, SIGKILL);
+        waitpid(solver_pid, NULL, 0);
+        solver_pid = 0;
+
+        char saved[sizeof(directory) + 16];
+        snprintf(saved, sizeof(saved), "%s/maze.bin", directory);
+        unlink(saved);
+        rmdir(directory);
+    }
+}
+
+// Returns 1 with a line (no newline), 0 on EOF, -1 on timeout
+static int read_line(char* line) {
+    while (1) {
+        char* newline = memchr(pending, '\n', pending_used);
+        if (newline) {
+            int length = newline - pending;
+            if (length >= LINE_SIZE)
+                length = LINE_SIZE - 1;
+            memcpy(line, pending, length);
+            line[length] = '\0';
+            int consumed = newline - pending + 1;
+            memmove(pending, pending + consumed, pending_used - consumed);
+            pending_used -= consumed;
+            return 1;
+        }
+
+        struct pollfd pfd = {from_solver, POLLIN, 0};
+        int ready = poll(&pfd, 1, REPLY_TIMEOUT_MS);
+        if (ready == 0)
+            return -1;
+        if (ready < 0 && errno == EINTR)
+            continue;
+
+        ssize_t n = read(from_solver, pending + pending_used, sizeof(pending) - pending_used);
+        if (n <= 0)
+            return 0;
+        pending_used += n;
+    }
+}
+
+static void reply(const char* text) {
+    char line[LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "%s\n", text);
+    if (write(to_solver, line, length) != length)
+        fprintf(stderr, "replay: solver stopped reading\n");
+}
+
+static void describe(const Record* r, char* out, size_t size) {
+    const char* name = op_names[r->op];
+    switch (r->op) {
+        case TRACE_SET_WALL:
+        case TRACE_CLEAR_WALL:
+        case TRACE_SET_COLOR:
+            snprintf(out, size, "%s %d %d %c", name, r->x, r->y, r->arg);
+            break;
+        case TRACE_CLEAR_COLOR:
+        case TRACE_CLEAR_TEXT:
+            snprintf(out, size, "%s %d %d", name, r->x, r->y);
+            break;
+        case TRACE_SET_TEXT:
+            snprintf(out, size, "%s %d %d %s", name, r->x, r->y, r->text);
+            break;
+        default:
+            snprintf(out, size, "%s", name);
+            break;
+    }
+}
+
+static void answer(const Record* r) {
+    char text[32];
+    switch (r->op) {
+        case TRACE_MAZE_WIDTH:
+        case TRACE_MAZE_HEIGHT:
+            snprintf(text, sizeof(text), "%d", r->result);
+            reply(text);
+            break;
+        case TRACE_WALL_FRONT:
+        case TRACE_WALL_RIGHT:
+        case TRACE_WALL_LEFT:
+        case TRACE_WAS_RESET:
+            reply(r->result ? "true" : "false");
+            break;
+        case TRACE_MOVE_FORWARD:
+            reply(r->result ? "ack" : "crash");
+            break;
+        case TRACE_TURN_RIGHT:
+        case TRACE_TURN_LEFT:
+        case TRACE_ACK_RESET:
+            reply("ack");
+            break;
+        default:
+            break;  // display commands get no reply
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        verbose = 1;
+        first = 2;
+    }
+    if (argc - first < 2) {
+        fprintf(stderr, "usage: replay [-v] <trace> <solver> [args...]\n");
+        return 2;
+    }
+    if (!load_trace(argv[first])) {
+        fprintf(stderr, "replay: cannot read trace %s\n", argv[first]);
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if (!start_solver(&argv[first + 1])) {
+        fprintf(stderr, "replay: cannot start %s\n", argv[first + 1]);
+        return 2;
+    }
+
+    // What the recorded run spent overall and waiting on the simulator
+    double recorded_total = 0;
+    double recorded_wait = 0;
+    for (int i = 0; i < record_count; i++) {
+        recorded_total += records[i].delta / 1e6;
+        recorded_wait += records[i].duration / 1e6;
+    }
+
+    double started = now_seconds();
+    int index = 0;
+    int calls = 0;
+    int status = 0;
+    char line[LINE_SIZE];
+
+    while (1) {
+        while (index < record_count && records[index].op == TRACE_DEBUG_LOG)
+            index++;
+        if (index >= record_count)
+            break;
+
+        int got = read_line(line);
+        if (got <= 0) {
+            fprintf(stderr, "replay: solver %s at call %d, expected %s\n",
+                    got == 0 ? "exited" : "went quiet", calls, op_names[records[index].op]);
+            status = 1;
+            break;
+        }
+
+        char expected[LINE_SIZE];
+        describe(&records[index], expected, sizeof(expected));
+        if (strcmp(line, expected) != 0) {
+            printf("DIVERGENCE at call %d (record %d): expected \"%s\", solver sent \"%s\"\n",
+                   calls, index, expected, line);
+            status = 1;
+            break;
+        }
+        if (verbose)
+            fprintf(stderr, "%6d %s\n", calls, line);
+
+        answer(&records[index]);
+        index++;
+        calls++;
+    }
+
+    double elapsed = now_seconds() - started;
+    stop_solver();
+
+    printf("Replayed %d calls in %.1f ms (recorded run: %.3f s, %.3f s of it in simulator round trips)\n",
+           calls, elapsed * 1e3, recorded_total, recorded_wait);
+    if (status == 0)
+        printf("No divergence\n");
+    return status;
+}
@@ -0,0 +1,255 @@
+// stress.c - Randomized stress runs for the solvers through headless
+//
+// Usage: stress [options] <headless> <solver> [solver args...]
+//   -n <cases>       mazes per algorithm (default 200)
+//   -s <seed>        seed of the first case (default 1)
+//   -z <size>        largest maze side (default 16, the solvers' MAX_SIZE)
+//   -a "<args>"      algorithm and parameters appended to the solver args;
+//                    repeat to stress several algorithms in one go
+//   -H "<options>"   extra headless options, e.g. "-x -f" to stress the
+//                    shared-memory backend and the fork server
+//   -r <runs>        runs per case (default 2), so the solvers' reset hooks
+//                    get stressed too
+//   -M <moves>       move budget per maze cell per run (default 16)
+//   -Q <queries>     round-trip budget per maze cell per run (default 128)
+//   -i               incomplete solver: giving up on a reachable maze is
+//                    allowed (wall followers); burning the budget never is
+//   -v               print every case, not only the failures
+//
+// Every case is a maze of random size from 5x5 up to -z (odd, even and
+// non-square sides) and a random kind from mazegen.h: loops, the goal on
+// an island, a walled-off goal room, or a walled-off centre. stress works
+// out whether the goal can be reached, runs headless on the case with
+// budgets scaled to the maze and the runs, and checks that the solver
+// either reached the goal on every run or, when the goal is out of reach,
+// gave up (exit status EXIT_GAVE_UP, strategy.h). Running out of budget,
+// stalling, idling, crashing or giving up on a reachable goal are failures;
+// each one is printed with the headless command that reproduces it. Ends
+// with one line per algorithm with the worst moves and round trips per cell
+// and run seen, and exits 1 if anything failed.
+//
+// Build: gcc -O2 stress.c -o stress
+#include "../Common/strategy.h"
+#include "mazegen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_ARGS 64
+#define MAX_ALGORITHMS 16
+
+typedef struct {
+    char result[32];
+    char exit[16];
+    long moves;
+    long queries;
+} Outcome;
+
+// Value of 'key=' in a headless summary line, copied into value
+static int field(const char* line, const char* key, char* value, int size) {
+    int key_length = strlen(key);
+    const char* start = line;
+    while (strncmp(start, key, key_length) != 0 || start[key_length] != '=') {
+        start = strchr(start, ' ');
+        if (!start)
+            return 0;
+        start++;
+    }
+    start += key_length + 1;
+    int length = strcspn(start, " \n");
+    if (length >= size)
+        length = size - 1;
+    memcpy(value, start, length);
+    value[length] = '\0';
+    return 1;
+}
+
+// Runs headless with argv and parses its summary line; 0 if it printed none
+static int run_headless(char* argv[], Outcome* outcome) {
+    int out[2];
+    if (pipe(out) < 0)
+        return 0;
+    pid_t pid = fork();
+    if (pid < 0)
+        return 0;
+    if (pid == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        close(out[1]);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    close(out[1]);
+
+    FILE* output = fdopen(out[0], "r");
+    char line[1024];
+    int found = 0;
+    while (fgets(line, sizeof(line), output)) {
+        if (strncmp(line, "result=", 7) != 0)
+            continue;
+        char number[32];
+        found = field(line, "result", outcome->result, sizeof(outcome->result)) &&
+                field(line, "exit", outcome->exit, sizeof(outcome->exit));
+        outcome->moves = field(line, "moves", number, sizeof(number)) ? atol(number) : 0;
+        outcome->queries = field(line, "queries", number, sizeof(number)) ? atol(number) : 0;
+    }
+    fclose(output);
+    waitpid(pid, NULL, 0);
+    return found;
+}
+
+// Splits 'words' in place on spaces onto args; returns the new count
+static int add_words(char* words, char* args[], int count) {
+    for (char* word = strtok(words, " "); word && count < MAX_ARGS - 1;
+         word = strtok(NULL, " "))
+        args[count++] = word;
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    long cases = 200;
+    unsigned seed = 1;
+    int max_size = 16;
+    long moves_per_cell = 16;
+    long queries_per_cell = 128;
+    int incomplete = 0;
+    int verbose = 0;
+    char* algorithms[MAX_ALGORITHMS];
+    int algorithm_count = 0;
+    const char* headless_options = "";
+    int runs = 2;
+
+    int arg = 1;
+    while (arg < argc && argv[arg][0] == '-') {
+        const char* flag = argv[arg];
+        if (strcmp(flag, "-i") == 0 || strcmp(flag, "-v") == 0) {
+            incomplete |= flag[1] == 'i';
+            verbose |= flag[1] == 'v';
+            arg++;
+            continue;
+        }
+        if (arg + 1 >= argc)
+            break;
+        long value = atol(argv[arg + 1]);
+        if (strcmp(flag, "-a") == 0 && algorithm_count < MAX_ALGORITHMS)
+            algorithms[algorithm_count++] = argv[arg + 1];
+        else if (strcmp(flag, "-H") == 0)
+            headless_options = argv[arg + 1];
+        else if (strcmp(flag, "-n") == 0)
+            cases = value;
+        else if (strcmp(flag, "-s") == 0)
+            seed = value;
+        else if (strcmp(flag, "-r") == 0)
+            runs = value;
+        else if (strcmp(flag, "-z") == 0)
+            max_size = value;
+        else if (strcmp(flag, "-M") == 0)
+            moves_per_cell = value;
+        else if (strcmp(flag, "-Q") == 0)
+            queries_per_cell = value;
+        else
+            break;
+        arg += 2;
+    }
+    if (argc - arg < 2 || cases < 1 || max_size < 5 || max_size > MAX_MAZE ||
+        runs < 1 || moves_per_cell < 1 || queries_per_cell < 1) {
+        fprintf(stderr, "usage: stress [-n cases] [-s seed] [-z size] [-r runs] [-a \"args\"]... "
+                        "[-H \"options\"] [-M moves] [-Q queries] [-i] [-v] "
+                        "<headless> <solver> [args...]\n");
+        return 2;
+    }
+    if (algorithm_count == 0)
+        algorithms[algorithm_count++] = "";
+
+    int failures = 0;
+    for (int a = 0; a < algorithm_count; a++) {
+        const char* label = algorithms[a][0] ? algorithms[a] : argv[arg + 1];
+        long goals = 0;
+        long gave_up = 0;
+        long failed = 0;
+        double worst_moves = 0;
+        double worst_queries = 0;
+
+        for (long i = 0; i < cases; i++) {
+            unsigned case_seed = seed + i;
+            rng_state = case_seed * 0x9E3779B97F4A7C15ULL + 7;
+            width = 5 + next_random() % (max_size - 4);
+            height = 5 + next_random() % (max_size - 4);
+            int kind = next_random() % MAZE_KINDS;
+            generate_maze_kind(case_seed, kind);
+            int reachable = goal_reachable();
+            long cells = (long)width * height;
+            double per_cell = (double)cells * runs;
+
+            char w[16], h[16], s[16], r[16], m[32], q[32];
+            snprintf(w, sizeof(w), "%d", width);
+            snprintf(h, sizeof(h), "%d", height);
+            snprintf(s, sizeof(s), "%u", case_seed);
+            snprintf(r, sizeof(r), "%d", runs);
+            snprintf(m, sizeof(m), "%ld", cells * moves_per_cell * runs);
+            snprintf(q, sizeof(q), "%ld", cells * queries_per_cell * runs);
+            char* args[MAX_ARGS] = {argv[arg], "-w", w, "-h", h, "-s", s, "-k",
+                                    (char*)maze_kind_names[kind], "-r", r, "-m", m, "-q", q};
+            int count = 15;
+            char options[256];
+            snprintf(options, sizeof(options), "%s", headless_options);
+            count = add_words(options, args, count);
+            for (int j = arg + 1; j < argc && count < MAX_ARGS - 1; j++)
+                args[count++] = argv[j];
+            char scratch[256];
+            snprintf(scratch, sizeof(scratch), "%s", algorithms[a]);
+            count = add_words(scratch, args, count);
+            args[count] = NULL;
+
+            Outcome outcome;
+            const char* verdict = NULL;
+            if (!run_headless(args, &outcome)) {
+                snprintf(outcome.result, sizeof(outcome.result), "none");
+                snprintf(outcome.exit, sizeof(outcome.exit), "?");
+                outcome.moves = outcome.queries = 0;
+                verdict = "headless printed no summary";
+            } else if (strcmp(outcome.result, "goal") == 0) {
+                goals++;
+                if (!reachable)
+                    verdict = "reached an unreachable goal";
+            } else if (strcmp(outcome.result, "exited") == 0 &&
+                       atoi(outcome.exit) == EXIT_GAVE_UP) {
+                gave_up++;
+                if (reachable && !incomplete)
+                    verdict = "gave up on a reachable goal";
+            } else if (strcmp(outcome.result, "exited") == 0) {
+                verdict = "crashed";
+            } else {
+                verdict = "did not terminate";  // budget, stall or idle timeout
+            }
+
+            if (outcome.moves / per_cell > worst_moves)
+                worst_moves = outcome.moves / per_cell;
+            if (outcome.queries / per_cell > worst_queries)
+                worst_queries = outcome.queries / per_cell;
+
+            if (verdict || verbose) {
+                printf("%s algorithm=\"%s\" kind=%s maze=%dx%d seed=%u reachable=%d result=%s "
+                       "exit=%s moves=%ld queries=%ld", verdict ? "FAIL" : "ok", label,
+                       maze_kind_names[kind], width, height, case_seed, reachable,
+                       outcome.result, outcome.exit, outcome.moves, outcome.queries);
+                if (verdict) {
+                    printf(" (%s)\n  repro:", verdict);
+                    for (int j = 0; j < count; j++)
+                        printf(" %s", args[j]);
+                }
+                printf("\n");
+            }
+            failed += verdict != NULL;
+        }
+
+        printf("algorithm=\"%s\" cases=%ld goals=%ld gave_up=%ld failures=%ld "
+               "worst_moves_per_cell=%.1f worst_queries_per_cell=%.1f\n",
+               label, cases, goals, gave_up, failed, worst_moves, worst_queries);
+        fflush(stdout);
+        failures += failed;
+    }
+    return failures ? 1 : 0;
+}
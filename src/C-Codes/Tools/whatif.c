@@ -0,0 +1,162 @@
+// whatif.c - Branch the FloodFillxA* solver at a checkpoint and compare strategies
+//
+// Usage: whatif [-s seed] [-b step] [-m max_steps]
+//   -s <seed>        maze seed (mazegen.h, 16x16; default 1)
+//   -b <step>        driver step to branch at (default 40)
+//   -m <steps>       step budget per branch (default 20000)
+//
+// Links the solver in-process against a generated maze, runs it with the
+// default strategy up to the branch step and takes a SolverSnapshot
+// (snapshot.h). Every exploration strategy then continues from a copy of
+// that snapshot, without replaying the prefix, until its optimal run is
+// done. One line per strategy reports the moves and turns it still needed.
+//
+// Build (from src/C-Codes):
+//   gcc -O2 -DHEADLESS -pthread -ICommon -I"FloodFillxA*" Tools/whatif.c "FloodFillxA*"/*.c
+//       Common/strategy.c Common/maze.c Common/log.c Common/profile.c Common/capture.c
+//       -o Tools/whatif
+#include "API.h"
+#include "mazegen.h"
+#include "snapshot.h"
+#include "strategy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SAVED_MAZE "maze.bin"
+
+typedef struct {
+    int x, y, dir;
+    long moves, turns, steps;
+} Mouse;
+
+static Mouse mouse;
+
+int API_mazeWidth() {
+    return width;
+}
+
+int API_mazeHeight() {
+    return height;
+}
+
+int API_wallFront() {
+    return (maze[mouse.x][mouse.y] >> mouse.dir) & 1;
+}
+
+int API_wallRight() {
+    return (maze[mouse.x][mouse.y] >> ((mouse.dir + 1) % 4)) & 1;
+}
+
+int API_wallLeft() {
+    return (maze[mouse.x][mouse.y] >> ((mouse.dir + 3) % 4)) & 1;
+}
+
+int API_moveForward() {
+    if (API_wallFront())
+        return 0;
+    mouse.x += dx[mouse.dir];
+    mouse.y += dy[mouse.dir];
+    mouse.moves++;
+    return 1;
+}
+
+void API_turnRight() {
+    mouse.dir = (mouse.dir + 1) % 4;
+    mouse.turns++;
+}
+
+void API_turnLeft() {
+    mouse.dir = (mouse.dir + 3) % 4;
+    mouse.turns++;
+}
+
+void debug_log(char* text) {
+    (void)text;
+}
+
+// One driver step, as in main.c
+static void step() {
+    switch (floodfill_astar_strategy.step()) {
+        case FORWARD:
+            API_moveForward();
+            break;
+        case LEFT:
+            API_turnLeft();
+            break;
+        case RIGHT:
+            API_turnRight();
+            break;
+        case IDLE:
+        case GIVE_UP:
+            break;
+    }
+    mouse.steps++;
+}
+
+static double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char* argv[]) {
+    static SolverSnapshot checkpoint;
+    unsigned seed = 1;
+    long branch_step = 40;
+    long max_steps = 20000;
+
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        long value = atol(argv[arg + 1]);
+        if (strcmp(argv[arg], "-s") == 0)
+            seed = value;
+        else if (strcmp(argv[arg], "-b") == 0)
+            branch_step = value;
+        else if (strcmp(argv[arg], "-m") == 0)
+            max_steps = value;
+        else {
+            fprintf(stderr, "usage: whatif [-s seed] [-b step] [-m max_steps]\n");
+            return 2;
+        }
+    }
+
+    // The solver keeps its map in maze.bin; start from nothing
+    unlink(SAVED_MAZE);
+    generate_maze(seed);
+    floodfill_astar_strategy.init();
+    while (mouse.steps < branch_step && !solver_done())
+        step();
+    if (solver_done()) {
+        fprintf(stderr, "whatif: solver finished after %ld steps, before the branch\n",
+                mouse.steps);
+        unlink(SAVED_MAZE);
+        return 1;
+    }
+
+    double started = now_us();
+    solver_snapshot(&checkpoint);
+    double snapshot_us = now_us() - started;
+    Mouse at_branch = mouse;
+    printf("checkpoint seed=%u step=%ld moves=%ld turns=%ld snapshot_bytes=%zu snapshot_us=%.1f\n",
+           seed, at_branch.steps, at_branch.moves, at_branch.turns, sizeof(checkpoint),
+           snapshot_us);
+
+    for (int strategy = 0; strategy < EXPLORE_STRATEGIES; strategy++) {
+        started = now_us();
+        solver_restore(&checkpoint);
+        double restore_us = now_us() - started;
+        mouse = at_branch;
+        solver_set_strategy(strategy);
+
+        while (!solver_done() && mouse.steps - at_branch.steps < max_steps)
+            step();
+        printf("strategy=%s finished=%d remaining_moves=%ld remaining_turns=%ld steps=%ld "
+               "restore_us=%.1f\n",
+               explore_strategy_names[strategy], solver_done(), mouse.moves - at_branch.moves,
+               mouse.turns - at_branch.turns, mouse.steps - at_branch.steps, restore_us);
+    }
+
+    unlink(SAVED_MAZE);
+    return 0;
+}